@@ -1,10 +1,12 @@
 #pragma once
 #include "batch_executor.hpp"
+#include "task_group.hpp"
 #include <filesystem>
 #include <fstream>
 #include <future>
 #include <queue>
-#include <boost/asio.hpp>
+#include <utility>
+#include <cstring>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -14,8 +16,6 @@ class AsyncFSExecutor : public BatchExecutor {
   private:
     static constexpr size_t WRITE_BUFFER_SIZE = 1024 * 64;
     static constexpr size_t READ_BUFFER_SIZE = 1024 * 1024; // 1 MB for reads
-    boost::asio::io_context _io_context;
-    boost::asio::thread_pool _io_pool;
 
     struct FileOp {
         std::filesystem::path path;
@@ -28,10 +28,10 @@ class AsyncFSExecutor : public BatchExecutor {
 
     struct WriteBatch {
         static constexpr size_t BATCH_SIZE = 8;
-        std::vector<std::shared_ptr<FileOp>> ops;
+        std::vector<std::unique_ptr<FileOp>> ops;
         
-        void add(std::shared_ptr<FileOp> op) {
-            ops.emplace_back(op);
+        void add(std::unique_ptr<FileOp> op) {
+            ops.emplace_back(std::move(op));
         }
 
         bool full() const { return ops.size() >= BATCH_SIZE; }
@@ -51,20 +51,21 @@ class AsyncFSExecutor : public BatchExecutor {
 
     struct ReadBatch {
         static constexpr size_t BATCH_SIZE = 32;
-        std::vector<std::shared_ptr<FileOp>> ops;
+        std::vector<std::unique_ptr<FileOp>> ops;
         
-        void add(std::shared_ptr<FileOp> op) {
-            ops.emplace_back(op);
+        void add(std::unique_ptr<FileOp> op) {
+            ops.emplace_back(std::move(op));
         }
 
         bool full() const { return ops.size() >= BATCH_SIZE; }
 
-        void execute(boost::asio::thread_pool& pool) {
-            std::vector<std::shared_ptr<FileOp>> pending_ops = ops;
-            std::atomic<size_t> completed{0};
+        // ops outlive the posted reads, execute() waits for all of them
+        void execute(Executor& executor) {
+            TaskGroup reads(executor);
+            reads.add(ops.size());
 
-            for (auto& op : pending_ops) {
-                boost::asio::post(pool, [op, &completed]() {
+            for (auto& opPtr : ops) {
+                auto admission = executor.scheduleBlocking([op = opPtr.get(), &reads]() {
                     try {
                         std::ifstream file(op->path, std::ios::binary);
                         size_t bytes = file.read(op->buffer.data(), READ_BUFFER_SIZE).gcount();
@@ -72,21 +73,20 @@ class AsyncFSExecutor : public BatchExecutor {
                     } catch(const std::exception& e) {
                         op->result.set_exception(std::current_exception());
                     }
-                    completed++;
+                    reads.arrive();
                 });
+                if (admission == Admission::Rejected) reads.arrive();
             }
 
-            while (completed < pending_ops.size()) {
-                std::this_thread::yield();
-            }
+            reads.wait();
         }
 
-        void execute_mmap(boost::asio::thread_pool& pool) {
-            std::vector<std::shared_ptr<FileOp>> pending_ops = ops;
-            std::atomic<size_t> completed{0};
+        void execute_mmap(Executor& executor) {
+            TaskGroup reads(executor);
+            reads.add(ops.size());
 
-            for (auto& op : pending_ops) {
-                boost::asio::post(pool, [op, &completed]() {
+            for (auto& opPtr : ops) {
+                auto admission = executor.scheduleBlocking([op = opPtr.get(), &reads]() {
                     try {
                         //Open file for mem mapping
                         int fd = open(op->path.c_str(), O_RDONLY);
@@ -118,39 +118,35 @@ class AsyncFSExecutor : public BatchExecutor {
                     } catch (std::exception& e) {
                         op->result.set_exception(std::current_exception());
                     }
-                    completed++;
+                    reads.arrive();
                 });
+                if (admission == Admission::Rejected) reads.arrive();
             }
 
-            while (completed < pending_ops.size()) {
-                std::this_thread::yield();
-            }
+            reads.wait();
         }            
     };
 
   public:
+    //File I/O runs on the executor's blocking pool. So do processDirAsync()'s
+    //processor calls, a processor is handed a file and may read it.
     AsyncFSExecutor(const Config& config) 
-      : BatchExecutor(config),
-        _io_pool(config.threadCount) {}
+      : BatchExecutor(config) {}
     
     //Async file read operation
     std::future<size_t> readFileAsync(const std::filesystem::path& path) {
-        auto op = std::make_shared<FileOp>(path, READ_BUFFER_SIZE);
+        auto op = std::make_unique<FileOp>(path, READ_BUFFER_SIZE);
         auto future = op->result.get_future();
 
-        auto task = [this, op]() {
-            boost::asio::post(_io_pool, [op]() {
-                try {
-                    std::ifstream file(op->path, std::ios::binary);
-                    size_t bytes = file.read(op->buffer.data(), READ_BUFFER_SIZE).gcount();
-                    op->result.set_value(bytes);
-                } catch (const std::exception& e) {
-                    op->result.set_exception(std::current_exception());
-                }
-            });
-        };
-
-        schedule(Task(std::move(task)));
+        scheduleBlocking([op = std::move(op)]() {
+            try {
+                std::ifstream file(op->path, std::ios::binary);
+                size_t bytes = file.read(op->buffer.data(), READ_BUFFER_SIZE).gcount();
+                op->result.set_value(bytes);
+            } catch (const std::exception& e) {
+                op->result.set_exception(std::current_exception());
+            }
+        });
         return future;
     } 
 
@@ -159,23 +155,19 @@ class AsyncFSExecutor : public BatchExecutor {
         const std::filesystem::path& path,
         const std::vector<char>& data) {
         
-        auto op = std::make_shared<FileOp>(path, WRITE_BUFFER_SIZE);
+        auto op = std::make_unique<FileOp>(path, WRITE_BUFFER_SIZE);
         op->buffer = data;
         auto future = op->result.get_future();
         
-        auto task = [this, op]() {
-            boost::asio::post(_io_pool, [op]() {
-                try {
-                    std::ofstream file(op->path, std::ios::binary);
-                    file.write(op->buffer.data(), op->buffer.size());
-                    op->result.set_value(op->buffer.size());
-                } catch (const std::exception& e) {
-                    op->result.set_exception(std::current_exception());
-                }
-            });
-        };
-
-        schedule(Task(std::move(task)));
+        scheduleBlocking([op = std::move(op)]() {
+            try {
+                std::ofstream file(op->path, std::ios::binary);
+                file.write(op->buffer.data(), op->buffer.size());
+                op->result.set_value(op->buffer.size());
+            } catch (const std::exception& e) {
+                op->result.set_exception(std::current_exception());
+            }
+        });
         return future;
     }
     
@@ -186,22 +178,20 @@ class AsyncFSExecutor : public BatchExecutor {
         
         static thread_local WriteBatch batch;
         
-        auto op = std::make_shared<FileOp>(path, WRITE_BUFFER_SIZE);
+        auto op = std::make_unique<FileOp>(path, WRITE_BUFFER_SIZE);
         op->buffer = data;
         auto future = op->result.get_future();
+        auto opPtr = op.get();
         
-        batch.add(op);
+        batch.add(std::move(op));
         
-        if (batch.full() || op == batch.ops.back()) {
+        if (batch.full() || opPtr == batch.ops.back().get()) {
             auto currentBatch = std::move(batch);
             batch = WriteBatch();
             
-            auto task = [this, b = std::move(currentBatch)]() mutable {
-                boost::asio::post(_io_pool, [b = std::move(b)]() mutable {
-                    b.execute();
-                });
-            };
-            schedule(Task(std::move(task)));
+            scheduleBlocking([b = std::move(currentBatch)]() mutable {
+                b.execute();
+            });
         }
         return future;
     }
@@ -210,43 +200,55 @@ class AsyncFSExecutor : public BatchExecutor {
     std::future<size_t> readFileAsyncBatch(const std::filesystem::path& path) {
         static thread_local ReadBatch batch;
 
-        auto op = std::make_shared<FileOp>(path, READ_BUFFER_SIZE);
+        auto op = std::make_unique<FileOp>(path, READ_BUFFER_SIZE);
         auto future = op->result.get_future();
-        batch.add(op);
+        auto opPtr = op.get();
+        batch.add(std::move(op));
 
-        if (batch.full() ||  op == batch.ops.back()) {
+        if (batch.full() ||  opPtr == batch.ops.back().get()) {
             auto currentBatch = std::move(batch);
             batch = ReadBatch();
 
-            auto task = [this, b = std::move(currentBatch)]() mutable {
-                     b.execute(_io_pool);
-            };
-            schedule(Task(std::move(task)));
+            // The batch waits for its reads, a blocking thread can afford to
+            scheduleBlocking([this, b = std::move(currentBatch)]() mutable {
+                b.execute(*this);
+            });
         }
         return future;
     }
 
-    //Directory traversal with async processing
+    //Directory traversal with async processing. The traversal is a CPU worker task,
+    //each processor call goes to the blocking pool. With a group, the traversal and
+    //every processor call are counted in it, group->wait() returns once all ran.
     template<typename Func>
-    void processDirAsync(const std::filesystem::path& dirPath, Func processor) {
-        auto task  = [this, dirPath, processor] () {
+    void processDirAsync(const std::filesystem::path& dirPath, Func processor, TaskGroup* group = nullptr) {
+        if (group) group->add(1);
+        auto task  = [this, dirPath, processor, group] () {
+            // Collect the per-file tasks and submit them in one batch
+            std::vector<Task> fileTasks;
             try {
                 for(const auto& entry : std::filesystem::recursive_directory_iterator(dirPath)) {
                     if (entry.is_regular_file()) {
-                        auto process_task = [this, entry, processor]() {
-                            boost::asio::post(_io_pool, [entry, processor]() {
+                        auto process_task = [this, entry, processor, group]() {
+                            auto admission = scheduleBlocking([entry, processor, group]() {
                                 processor(entry);    
+                                if (group) group->arrive();
                             });
+                            if (group && admission == Admission::Rejected) group->arrive();
                         };
-                        schedule(Task(std::move(process_task)));
+                        fileTasks.emplace_back(std::move(process_task));
                     }
                 }
             } catch (const std::exception& e) {
                 std::cerr << "Dir processing error: " << e.what() << std::endl;
             }
+            if (group) group->add(fileTasks.size());
+            scheduleBatch(std::span<Task>(fileTasks));
+            if (group) group->arrive(); //the traversal itself
         };
 
-        schedule(Task(std::move(task)));
+        auto admission = schedule(Task(std::move(task)));
+        if (group && (admission == Admission::Rejected || admission == Admission::Shed)) group->arrive();
     }
 
 };
@@ -8,10 +8,9 @@ public:
 
 private:
     static constexpr size_t DEFAULT_BATCH_SIZE = 64;
-    thread_local static inline MPMCQueue<Task> *_localQ = nullptr;
 
     struct alignas(64) TaskBatch { // Cache line alignment
-        std::vector<Task> taskbatchQ; //Use LIFO strategy
+        std::vector<Task> taskbatchQ; //In global queue order
          size_t maxSize;
      
         explicit TaskBatch(size_t size = DEFAULT_BATCH_SIZE) : maxSize(size) {
@@ -26,54 +25,78 @@ private:
         void add(Task &&task) {
             taskbatchQ.emplace_back(std::move(task));
         }
-
-        Task take() {
-            Task task = std::move(taskbatchQ.back());
-            taskbatchQ.pop_back();
-            return task;
-        }
     };
 
 protected:
-    virtual void run() override
-    {
-        // Init thread-local queue
-        _localQ = new MPMCQueue<Task>(_taskPoolSize / _config.threadCount);
-        Executor::run();
-        delete _localQ;
-    }
-
     virtual bool getNextTask(Task &task) override
     {
-        // First try localQ
-        if (_localQ && _localQ->try_pop(task))
+        // Deadline tasks jump the batches
+        if (popDeadlineTask(task))
             return true;
 
-        // Try to get a batch of tasks
-        TaskBatch batch(_config.batchExecutorTaskBatchSize);
+        // What this worker just scheduled, while the slot's budget lasts
+        if (popLifoTask(task, true)) {
+            taskDequeued(task);
+            return true;
+        }
+
+        // Coroutines waiting to continue
+        if (popResumeTask(task))
+            return true;
 
-        for (size_t p = 0; p < static_cast<size_t>(Priority::kNumPriorities); ++p) {
-            while (!batch.full() && !_taskQArray[p]->empty()) {
-                if (_taskQArray[p]->try_pop(task)) {
-                    batch.add(std::move(task));
-                    _pendingTasks--;
-                }
+        // Level first, our deque and the global queue of a level count together,
+        // so a batch parked locally never runs ahead of a higher level queued globally
+        bool withLocal = _config.enableWorkStealing && isWorkerThread();
+        for (size_t attempt = 0; attempt < static_cast<size_t>(Priority::kNumPriorities); ++attempt) {
+            size_t p = nextPriorityLevel(withLocal);
+            if (p == static_cast<size_t>(Priority::kNumPriorities))
+                break;
+
+            // Rest of an earlier batch, or subtasks spawned by this worker
+            if (withLocal && localQueue(p).pop(task)) {
+                taskDequeued(task);
+                return true;
             }
-            if (!batch.empty()) break; // limit to a single prio level batch tasks
+
+            if (popGlobalBatch(p, task))
+                return true;
         }
 
-        // If we got batch tasks, take one and put the rest in local Q
-        if (!batch.empty())
-        {
-            task = batch.take();
-            while (!batch.empty())
-            {
-                _localQ->push(batch.take());
-            }
+        // Last resort - try stealing
+        if (tryStealTask(task))
+            return true;
+
+        // Nothing else to run, the budget doesn't apply
+        if (popLifoTask(task, false)) {
+            taskDequeued(task);
             return true;
         }
 
-        // Last resort - try stealing
-        return tryStealTask(task);
+        // What another worker's slot has held while its owner stayed busy
+        return stealLifoTask(task);
+    }
+
+    // One task of level p from the global queue, plus a batch more of that level
+    // parked in our deque, still counted as queued. Idle workers can steal from it.
+    bool popGlobalBatch(size_t p, Task &task)
+    {
+        if (!popGlobal(p, task))
+            return false;
+        taskDequeued(task);
+
+        // Without a deque there is nowhere the level picker would see the rest
+        if (!_config.enableWorkStealing || !isWorkerThread())
+            return true;
+
+        TaskBatch batch(_config.batchExecutorTaskBatchSize);
+        Task next([] {});
+        while (!batch.full() && !globalEmpty(p)) {
+            if (popGlobal(p, next))
+                batch.add(std::move(next));
+        }
+
+        // Reversed, the deque pops its newest first and hands them out in order
+        localQueue(p).pushBulk(batch.taskbatchQ.rbegin(), batch.taskbatchQ.rend());
+        return true;
     }
 };
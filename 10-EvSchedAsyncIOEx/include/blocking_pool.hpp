@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+
+//Elastic pool for work that blocks: sleeps, file and socket I/O, waiting on locks.
+//A thread is added whenever more tasks are queued than threads are idle, up to
+//maxThreads, and a thread idle for keepAlive leaves. Tasks here spend their time
+//off the CPU, so one mutex and a condition variable cost nothing next to them and
+//keep the queue's memory bounded by what is actually queued.
+template <typename Fn>
+class BlockingPool {
+public:
+    struct Stats {
+        size_t threads{0};
+        size_t peakThreads{0};
+        size_t spawned{0};
+        size_t retired{0};  //threads that left after keepAlive idle
+        size_t tasksRun{0};
+        size_t queued{0};
+    };
+
+    BlockingPool(size_t maxThreads, std::chrono::steady_clock::duration keepAlive)
+      : _maxThreads(std::max<size_t>(maxThreads, 1)), _keepAlive(keepAlive) {}
+
+    BlockingPool(const BlockingPool&) = delete;
+    BlockingPool& operator=(const BlockingPool&) = delete;
+
+    ~BlockingPool() { stop(); }
+
+    //False once stopped, fn is left untouched
+    bool post(Fn& fn) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_stopped) return false;
+        _queue.push_back(std::move(fn));
+        if (_queue.size() > _idle && _threads < _maxThreads) spawn();
+        else if (_idle > 0) _cv.notify_one();
+        return true;
+    }
+
+    //Runs what is still queued, then joins every thread
+    void stop() {
+        std::list<Worker> workers;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopped = true;
+            workers.swap(_workers);
+        }
+        _cv.notify_all();
+        for (auto& worker : workers) {
+            if (worker.thread.joinable()) worker.thread.join();
+        }
+    }
+
+    //True on the pool's own threads
+    bool runningInThisThread() const { return currentPool == this; }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats stats = _stats;
+        stats.threads = _threads;
+        stats.queued = _queue.size();
+        return stats;
+    }
+
+private:
+    struct Worker {
+        std::thread thread;
+        bool exited{false};
+    };
+
+    //Called with _mutex held
+    void spawn() {
+        //Threads that retired since the last spawn are done, joining them doesn't block
+        for (auto it = _workers.begin(); it != _workers.end();) {
+            if (!it->exited) { ++it; continue; }
+            it->thread.join();
+            it = _workers.erase(it);
+        }
+
+        ++_threads;
+        ++_stats.spawned;
+        _stats.peakThreads = std::max(_stats.peakThreads, _threads);
+        auto& worker = _workers.emplace_back();
+        worker.thread = std::thread([this, &worker] { run(worker); });
+    }
+
+    void run(Worker& worker) {
+        currentPool = this;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            if (!_queue.empty()) {
+                Fn fn = std::move(_queue.front());
+                _queue.pop_front();
+                lock.unlock();
+                try {
+                    fn();
+                } catch (const std::exception& e) {
+                    std::cerr << "Blocking task exception: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Unknown blocking task exception occurred" << std::endl;
+                }
+                lock.lock();
+                ++_stats.tasksRun;
+                continue;
+            }
+            if (_stopped) break;
+
+            ++_idle;
+            bool woken = _cv.wait_for(lock, _keepAlive, [this] { return !_queue.empty() || _stopped; });
+            --_idle;
+            if (!woken) {
+                ++_stats.retired;
+                break;
+            }
+        }
+        --_threads;
+        worker.exited = true;
+    }
+
+    thread_local static inline const BlockingPool* currentPool = nullptr;
+
+    const size_t _maxThreads;
+    const std::chrono::steady_clock::duration _keepAlive;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<Fn> _queue;
+    std::list<Worker> _workers; //list: a running thread holds a reference to its entry
+    size_t _threads{0};
+    size_t _idle{0};
+    bool _stopped{false};
+    Stats _stats;
+};
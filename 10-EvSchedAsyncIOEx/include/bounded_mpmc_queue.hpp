@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+//Bounded MPMC ring (Vyukov). Every cell carries a sequence number that says whose
+//turn it is, so producers and consumers only contend on their own position counter.
+//Memory is allocated once up front, a full ring makes try_push fail instead of growing.
+template <typename T>
+class BoundedMPMCQueue {
+public:
+    explicit BoundedMPMCQueue(size_t capacity)
+      : _capacity(std::bit_ceil(std::max(capacity, size_t{2}))),
+        _mask(_capacity - 1),
+        _cells(new Cell[_capacity]) {
+        for (size_t i = 0; i < _capacity; ++i) _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+    BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+    ~BoundedMPMCQueue() {
+        for (size_t pos = _dequeuePos.load(); pos != _enqueuePos.load(); ++pos) {
+            std::launder(reinterpret_cast<T*>(_cells[pos & _mask].storage))->~T();
+        }
+    }
+
+    //False when full, value is left untouched
+    bool try_push(T&& value) {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = _cells[pos & _mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ::new (static_cast<void*>(cell.storage)) T(std::move(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; //the consumer a lap behind hasn't freed this cell
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = _cells[pos & _mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* slot = std::launder(reinterpret_cast<T*>(cell.storage));
+                    value = std::move(*slot);
+                    slot->~T();
+                    cell.sequence.store(pos + _capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //Approximate, a push in flight reads as empty
+    bool empty() const {
+        size_t pos = _dequeuePos.load(std::memory_order_acquire);
+        return _cells[pos & _mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    size_t capacity() const { return _capacity; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    alignas(64) std::atomic<size_t> _enqueuePos{0};
+    alignas(64) std::atomic<size_t> _dequeuePos{0};
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//CPUs usable by this process grouped by NUMA node.
+//Linux reads /sys/devices/system/node and honours the affinity mask,
+//everywhere else (or without sysfs) we report a single node.
+class CpuTopology {
+public:
+    struct Cpu {
+        int id;
+        size_t node;
+    };
+
+    //How much CPU the process can really use. Containers cap it with the affinity
+    //mask (cpuset) and the cgroup CPU quota, hardware_concurrency() sees neither.
+    struct CpuLimits {
+        size_t hardwareThreads{1}; //hardware_concurrency()
+        size_t affinityCpus{1};    //CPUs in the affinity mask
+        double quotaCpus{0.0};     //cgroup quota / period, 0 when there is none
+        std::string quotaSource;   //file the quota was read from
+        size_t usableCpus{1};      //affinityCpus, capped by the quota rounded down, at least 1
+    };
+
+    static CpuTopology detect() {
+        CpuTopology topology;
+        auto allowed = allowedCpus();
+
+#if defined(__linux__)
+        //Node ids can have gaps (offline or memory-less nodes), "online" lists the real ones
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string nodelist;
+        std::getline(online, nodelist);
+        for (int node : parseCpuList(nodelist)) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) continue;
+
+            std::string cpulist;
+            std::getline(file, cpulist);
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(cpulist)) {
+                if (std::find(begin(allowed), end(allowed), cpu) != end(allowed)) cpus.emplace_back(cpu);
+            }
+            if (!cpus.empty()) topology._nodes.emplace_back(std::move(cpus));
+        }
+#endif
+        if (topology._nodes.empty()) topology._nodes.emplace_back(std::move(allowed));
+        return topology;
+    }
+
+    //The quota is the tightest one on the way from the process's cgroup to the root:
+    //cpu.max on cgroup v2, cpu.cfs_quota_us / cpu.cfs_period_us on v1. Rounded down
+    //so a pool sized to it doesn't run into throttling.
+    static CpuLimits detectLimits() {
+        CpuLimits limits;
+        limits.hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        limits.affinityCpus = allowedCpus().size();
+        limits.usableCpus = limits.affinityCpus;
+
+#if defined(__linux__)
+        std::ifstream file("/proc/self/cgroup");
+        std::string line;
+        while (std::getline(file, line)) {
+            //"hierarchy:controllers:path", v2 is hierarchy 0 without controllers
+            auto first = line.find(':');
+            auto second = line.find(':', first + 1);
+            if (first == std::string::npos || second == std::string::npos) continue;
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if (controllers.empty()) {
+                for (const char* root : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) applyQuota(limits, root, path, true);
+            } else if (hasController(controllers, "cpu")) {
+                for (const char* root : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"}) applyQuota(limits, root, path, false);
+            }
+        }
+#endif
+        if (limits.quotaCpus > 0) {
+            limits.usableCpus = std::min(limits.usableCpus, std::max<size_t>(static_cast<size_t>(limits.quotaCpus), 1));
+        }
+        return limits;
+    }
+
+    //detectLimits() once per process, what the Executor defaults are sized from
+    static const CpuLimits& limits() {
+        static const CpuLimits detected = detectLimits();
+        return detected;
+    }
+
+    size_t nodeCount() const { return _nodes.size(); }
+    const std::vector<int>& nodeCpus(size_t node) const { return _nodes[node]; }
+
+    size_t cpuCount() const {
+        size_t count = 0;
+        for (auto& cpus : _nodes) count += cpus.size();
+        return count;
+    }
+
+    //Order to hand CPUs to workers: node by node (compact) or round robin across nodes (spread)
+    std::vector<Cpu> placementOrder(bool spread) const {
+        std::vector<Cpu> order;
+        if (!spread) {
+            for (size_t node = 0; node < _nodes.size(); ++node) {
+                for (int cpu : _nodes[node]) order.push_back({cpu, node});
+            }
+            return order;
+        }
+
+        for (size_t i = 0; order.size() < cpuCount(); ++i) {
+            for (size_t node = 0; node < _nodes.size(); ++node) {
+                if (i < _nodes[node].size()) order.push_back({_nodes[node][i], node});
+            }
+        }
+        return order;
+    }
+
+    //Pin the calling thread to a single CPU, returns false if the OS refused or can't
+    static bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    //"0-3,8,10-11" -> {0,1,2,3,8,10,11}, node lists use the same format
+    static std::vector<int> parseCpuList(const std::string& cpulist) {
+        std::vector<int> cpus;
+        std::stringstream ss(cpulist);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            auto dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) cpus.emplace_back(cpu);
+            } catch (const std::exception&) {
+                //malformed entry, skip it
+            }
+        }
+        return cpus;
+    }
+
+private:
+    static std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.emplace_back(cpu);
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++cpu) {
+                cpus.emplace_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    static bool hasController(const std::string& controllers, const std::string& name) {
+        std::stringstream ss(controllers);
+        std::string controller;
+        while (std::getline(ss, controller, ',')) {
+            if (controller == name) return true;
+        }
+        return false;
+    }
+
+    //Walks from the cgroup up to the hierarchy's root. In a container with its own
+    //cgroup namespace the path doesn't exist under root, the root is its cgroup.
+    //Each step cuts path at its last '/', a path without one stops the walk.
+    static void applyQuota(CpuLimits& limits, const std::string& root, const std::string& path, bool v2) {
+        size_t end = path == "/" ? 0 : path.size();
+        while (true) {
+            std::string dir = root;
+            dir.append(path, 0, end);
+            double cpus = v2 ? readCpuMax(dir) : readCfsQuota(dir);
+            if (cpus > 0 && (limits.quotaCpus == 0 || cpus < limits.quotaCpus)) {
+                limits.quotaCpus = cpus;
+                limits.quotaSource = dir + (v2 ? "/cpu.max" : "/cpu.cfs_quota_us");
+            }
+            if (end == 0) return;
+            auto slash = path.rfind('/', end - 1);
+            if (slash == std::string::npos) return;
+            end = slash;
+        }
+    }
+
+    //"max 100000" or "<quota> <period>", 0 for no limit
+    static double readCpuMax(const std::string& dir) {
+        std::ifstream file(dir + "/cpu.max");
+        std::string quota;
+        double period = 0;
+        if (!(file >> quota >> period) || quota == "max" || period <= 0) return 0;
+        try {
+            return std::stod(quota) / period;
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+
+    //cpu.cfs_quota_us is -1 for no limit
+    static double readCfsQuota(const std::string& dir) {
+        std::ifstream quotaFile(dir + "/cpu.cfs_quota_us");
+        std::ifstream periodFile(dir + "/cpu.cfs_period_us");
+        double quota = 0, period = 0;
+        if (!(quotaFile >> quota) || !(periodFile >> period) || quota <= 0 || period <= 0) return 0;
+        return quota / period;
+    }
+
+    std::vector<std::vector<int>> _nodes;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+//Earliest-deadline-first queue shared by all workers.
+//A binary min-heap behind a mutex; the size is mirrored in an atomic so
+//workers can skip the lock when there is nothing to run. Equal deadlines
+//pop in submission order.
+template <typename T>
+class DeadlineQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void push(Clock::time_point deadline, T value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _heap.push_back({deadline, _nextSeq++, std::move(value)});
+        std::push_heap(begin(_heap), end(_heap), later);
+        _size.store(_heap.size(), std::memory_order_release);
+    }
+
+    bool try_pop(T& value, Clock::time_point& deadline) {
+        if (empty()) return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_heap.empty()) return false;
+
+        std::pop_heap(begin(_heap), end(_heap), later);
+        deadline = _heap.back().deadline;
+        value = std::move(_heap.back().value);
+        _heap.pop_back();
+        _size.store(_heap.size(), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return _size.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t seq;
+        T value;
+    };
+
+    //std heaps are max-heaps, so "less" means "runs later"
+    static bool later(const Entry& a, const Entry& b) {
+        if (a.deadline != b.deadline) return a.deadline > b.deadline;
+        return a.seq > b.seq;
+    }
+
+    std::mutex _mutex;
+    std::vector<Entry> _heap;
+    uint64_t _nextSeq{0};
+    std::atomic<size_t> _size{0};
+};
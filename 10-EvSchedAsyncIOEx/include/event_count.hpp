@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+//Spin-wait hint: lets the sibling hyperthread run and saves power while polling
+inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+//Eventcount used to park idle workers without a global lock.
+//Notifiers pay a single atomic load when nobody is parked, parking and
+//waking go through a futex on Linux and a private cv everywhere else.
+//
+//Waiter protocol:
+//    auto key = ec.prepareWait();
+//    if (conditionHolds()) { ec.cancelWait(); ... }
+//    else ec.waitUntil(key, deadline);
+class EventCount {
+public:
+    using Key = uint32_t;
+
+    Key prepareWait() noexcept {
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _epoch.load(std::memory_order_acquire);
+    }
+
+    void cancelWait() noexcept {
+        _waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    //Returns false if the deadline passed before a notification arrived
+    template<typename Clock, typename Duration>
+    bool waitUntil(Key key, std::chrono::time_point<Clock, Duration> deadline) {
+        bool notified = true;
+        while (_epoch.load(std::memory_order_acquire) == key) {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Duration::zero()) {
+                notified = false;
+                break;
+            }
+            park(key, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+        }
+        _waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return notified;
+    }
+
+    void notifyOne() noexcept { notify(1); }
+    void notifyAll() noexcept { notify(INT_MAX); }
+
+    //Wakes up to count waiters in one round, fewer if fewer are parked
+    void notifyMany(size_t count) noexcept {
+        notify(static_cast<int>(std::min<size_t>(count, INT_MAX)));
+    }
+
+    size_t waiters() const noexcept { return _waiters.load(std::memory_order_relaxed); }
+
+private:
+    void notify(int count) noexcept {
+        //Pairs with the fence in prepareWait: either we see the waiter or it sees our work
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiters.load(std::memory_order_seq_cst) == 0) return;
+        _epoch.fetch_add(1, std::memory_order_release);
+        wake(count);
+    }
+
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+
+    void park(Key key, std::chrono::nanoseconds timeout) noexcept {
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(secs.count());
+        ts.tv_nsec = static_cast<long>((timeout - secs).count());
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+    }
+
+    void wake(int count) noexcept {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_epoch), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+#else
+    void park(Key key, std::chrono::nanoseconds timeout) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait_for(lock, timeout, [this, key] {
+            return _epoch.load(std::memory_order_acquire) != key;
+        });
+    }
+
+    void wake(int count) {
+        //Lock/unlock orders us after any waiter that checked the epoch but hasn't slept yet
+        { std::lock_guard<std::mutex> lock(_mutex); }
+        if (static_cast<size_t>(count) >= waiters()) _cv.notify_all();
+        else while (count-- > 0) _cv.notify_one();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+#endif
+
+    std::atomic<uint32_t> _epoch{0};
+    std::atomic<uint32_t> _waiters{0};
+};
@@ -4,16 +4,33 @@
 #include <vector>
 #include <memory>
 #include <any>
+#include <atomic>
 #include <string>
 #include <string_view>
 #include <coroutine>
 #include <stdexcept>
+#include <chrono>
 #include <iostream>
 #include "executor.hpp"
+#include "sharded_executor.hpp"
+#include "strand.hpp"
+#include "resume_queue.hpp"
 
 class EventScheduler {
 public:
 
+    //Any Executor works, EVENT_SCHEDULER_SHARDED picks the thread-per-core one
+    explicit EventScheduler(std::unique_ptr<Executor> executor = makeDefaultExecutor())
+      : _executor(std::move(executor)) {}
+
+    static std::unique_ptr<Executor> makeDefaultExecutor() {
+#ifdef EVENT_SCHEDULER_SHARDED
+        return std::make_unique<ShardedExecutor>();
+#else
+        return std::make_unique<Executor>();
+#endif
+    }
+
     struct Task {
         struct promise_type {
             Task get_return_object() {
@@ -38,6 +55,17 @@ public:
         std::coroutine_handle<promise_type> _handle;
     };
 
+private:
+    struct Event;
+
+public:
+    //A waiting handler as registered: its resume link and, once dispatched, the
+    //event it is being woken for
+    struct HandlerLink {
+        ResumeNode node;
+        Event* event{nullptr};
+    };
+
     template<typename T>
     struct EventAwaiter {
         EventAwaiter(EventScheduler& scheduler, std::string_view eventName)
@@ -46,16 +74,26 @@ public:
         bool await_ready() const noexcept { return false; }
         
         void await_suspend(std::coroutine_handle<> handle) {
-            _scheduler.registerHandler(_eventName, handle);
+            _link.node.handle = handle;
+            _scheduler.registerHandler(_eventName, _link);
         }
 
+        //The handler is counted as delivered once it has its copy of the data
         T await_resume() {
+            Delivered delivered{_scheduler, _link.event};
             return _scheduler.getEventData<T>(_eventName);
         }
 
     private:
+        struct Delivered {
+            EventScheduler& scheduler;
+            Event* event;
+            ~Delivered() { if (event) scheduler.handlerDelivered(event); }
+        };
+
         EventScheduler& _scheduler;
         std::string_view _eventName;
+        HandlerLink _link;
     };
 
     //Add executor-aware awaiter
@@ -63,24 +101,152 @@ public:
        
         ExecutorAwaiter(Executor& executor) : _executor(executor) {}
 
-        bool await_ready() const noexcept { return false; }
+        //Already on one of its workers: keep running, no queue round trip
+        bool await_ready() const noexcept { return Executor::current() == &_executor; }
 
-        void await_suspend(std::coroutine_handle<> handle) {
-            _executor.schedule( [handle] () { handle.resume();});
+        //Queued through the link below, nothing allocated. Stopped: carry on here.
+        bool await_suspend(std::coroutine_handle<> handle) {
+            _node.handle = handle;
+            return _executor.scheduleResume(_node);
         }
         
         void await_resume() {}
         
     private:
       Executor& _executor;
+      ResumeNode _node;
+
+    };
+
+    //Resume on a strand: the code up to the next suspension point runs serialised
+    //with everything else posted to that strand
+    struct StrandAwaiter {
+
+        StrandAwaiter(Strand& strand) : _strand(strand) {}
+
+        //Already inside one of its tasks, we hold the strand
+        bool await_ready() const noexcept { return _strand.runningInThisThread(); }
+
+        //A stopped executor runs nothing posted, carry on here rather than lose the coroutine
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return _strand.post( [handle] () { handle.resume();});
+        }
+
+        void await_resume() {}
+
+    private:
+      Strand& _strand;
+    };
+
+    //Requeue the coroutine at the back of its priority level. With onlyIfDue it
+    //only suspends once the running task has used up the executor's time slice,
+    //so it can sit in a hot loop. Off executor threads there is nothing to yield to.
+    struct YieldAwaiter {
+
+        explicit YieldAwaiter(bool onlyIfDue) : _onlyIfDue(onlyIfDue) {}
+
+        bool await_ready() const noexcept {
+            Executor* executor = Executor::current();
+            if (!executor || executor->pendingTasks() == 0) return true; //nobody to give way to
+            return _onlyIfDue && !Executor::shouldYield();
+        }
+
+        //Stopped meanwhile: nothing would resume it, keep running
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return Executor::current()->yieldTask( [handle] () { handle.resume();});
+        }
+
+        void await_resume() {}
+
+    private:
+      bool _onlyIfDue;
+    };
+
+    //Move the coroutine to the executor's blocking pool, the code up to the next
+    //resumeOnCpu() may sleep or block without taking a CPU worker away
+    struct BlockingAwaiter {
+
+        BlockingAwaiter(Executor& executor) : _executor(executor) {}
+
+        bool await_ready() const noexcept { return _executor.onBlockingThread(); }
+
+        //A stopped executor has no pool left, carry on where we are
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return _executor.scheduleBlocking( [handle] () { handle.resume();}) == Executor::Admission::Queued;
+        }
+
+        void await_resume() {}
+
+    private:
+      Executor& _executor;
+    };
+
+    //Back from the blocking pool to a CPU worker
+    struct CpuAwaiter {
+
+        CpuAwaiter(Executor& executor) : _executor(executor) {}
+
+        bool await_ready() const noexcept { return Executor::current() == &_executor; }
+
+        //A stopped executor can't take it back, keep running here rather than lose the coroutine
+        bool await_suspend(std::coroutine_handle<> handle) {
+            _node.handle = handle;
+            return _executor.scheduleResume(_node);
+        }
+
+        void await_resume() {}
+
+    private:
+      Executor& _executor;
+      ResumeNode _node;
+    };
+
+    //Suspend until a point in time without holding a worker, resumes on the executor
+    struct SleepAwaiter {
+
+        SleepAwaiter(Executor& executor, Executor::Deadline wakeAt) : _executor(executor), _wakeAt(wakeAt) {}
+
+        bool await_ready() const noexcept { return _wakeAt <= std::chrono::steady_clock::now(); }
 
+        //Refused timer: wake up now rather than never
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return _executor.tryScheduleAt(_wakeAt, [handle] () { handle.resume();});
+        }
+
+        void await_resume() {}
+
+    private:
+      Executor& _executor;
+      Executor::Deadline _wakeAt;
     };
 
-    Executor& getExecutor() { return _executor; }
+    Executor& getExecutor() { return *_executor; }
 
     // Add helper to switch executors
     ExecutorAwaiter switchToExecutor() {
-        return ExecutorAwaiter(_executor);
+        return ExecutorAwaiter(*_executor);
+    }
+
+    template<typename Rep, typename Period>
+    SleepAwaiter sleepFor(std::chrono::duration<Rep, Period> duration) {
+        return SleepAwaiter(*_executor, std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration));
+    }
+
+    SleepAwaiter sleepUntil(Executor::Deadline wakeAt) {
+        return SleepAwaiter(*_executor, wakeAt);
+    }
+
+    BlockingAwaiter offloadBlocking() {
+        return BlockingAwaiter(*_executor);
+    }
+
+    CpuAwaiter resumeOnCpu() {
+        return CpuAwaiter(*_executor);
+    }
+
+    StrandAwaiter switchToStrand(Strand& strand) {
+        return StrandAwaiter(strand);
     }
 
     static EventScheduler& getInstance() {
@@ -88,14 +254,16 @@ public:
         return instance;
     }
 
-    void registerHandler(std::string_view eventName, std::coroutine_handle<> handle) {
+    void registerHandler(std::string_view eventName, HandlerLink& link) {
         std::cout << "Registering handler for: " << eventName << "\n" << std::flush;
         auto& handlersVec = _handlersMap[std::string(eventName)];
 
         // Don't register duplicate handles.
-        if (std::find(begin(handlersVec), end(handlersVec), handle) != end(handlersVec)) return;
+        auto sameHandle = [&link](const HandlerLink* other) { return other->node.handle == link.node.handle; };
+        if (std::find_if(begin(handlersVec), end(handlersVec), sameHandle) != end(handlersVec)) return;
         
-        handlersVec.emplace_back(handle);
+        link.event = nullptr;
+        handlersVec.emplace_back(&link);
     }
 
     template<typename T>
@@ -111,6 +279,7 @@ private:
         virtual ~Event() = default;
         virtual void storeData(std::unordered_map<std::string, std::any>& eventData) = 0;
         std::string eventName;
+        std::atomic<size_t> undelivered{0}; //handlers that haven't read the data yet
     };
 
     template<typename T>
@@ -132,38 +301,52 @@ private:
         return std::any_cast<T>(_eventDataMap[std::string(eventName)]);
     }
 
+    // The last handler to read the event's data drops it
+    void handlerDelivered(Event* event) {
+        if (event->undelivered.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        _eventDataMap.erase(event->eventName);
+        delete event;
+    }
+
     void processEvents() {
         while (!empty(_eventsQ)) {
             auto eventPtr = std::move(_eventsQ.front());
             _eventsQ.pop();
             
             eventPtr->storeData(_eventDataMap);
-            auto eventName = eventPtr->eventName;
+            const auto& eventName = eventPtr->eventName;
             
-            if (_handlersMap.count(eventName) == 0) continue;
-            size_t handlerCount = size(_handlersMap[eventName]);
-            if (handlerCount == 0) {
+            auto handlers = _handlersMap.find(eventName);
+            if (handlers == _handlersMap.end()) continue;
+            if (handlers->second.empty()) {
                 _eventDataMap.erase(eventName);
                 continue;
             }
-             
-            std::shared_ptr<size_t> completedCount = std::make_shared<size_t>(0);
-             
-            auto handlersVec = std::move(_handlersMap[eventName]);
-            _handlersMap.erase(eventName);
-
-            for (auto& handle : handlersVec) {
-                _executor.schedule([this, handle, eventName, handlerCount, completedCount]() {
-                    handle.resume();
-                    // Increment completed count and check if all handlers are done
-                    if (++(*completedCount) == handlerCount) { _eventDataMap.erase(eventName);}
-                });
+
+            // Handlers re-register into the emptied vector, both keep their capacity
+            _dispatching.swap(handlers->second);
+            size_t handlerCount = _dispatching.size();
+
+            // The event counts its own deliveries, handlerDelivered() frees it
+            Event* event = eventPtr.release();
+            event->undelivered.store(handlerCount, std::memory_order_relaxed);
+
+            // All handlers of the event go out as one chain of their own links
+            for (size_t i = 0; i < handlerCount; ++i) {
+                _dispatching[i]->event = event;
+                _dispatching[i]->node.next = i + 1 < handlerCount ? &_dispatching[i + 1]->node : nullptr;
             }
+            if (!_executor->scheduleResume(_dispatching.front()->node, handlerCount)) {
+                //Stopped executor, deliver on this thread
+                for (auto* link : _dispatching) link->node.handle.resume();
+            }
+            _dispatching.clear();
         }
     }
 
-    Executor _executor;
-    std::unordered_map<std::string, std::vector<std::coroutine_handle<>>> _handlersMap;
+    std::unique_ptr<Executor> _executor;
+    std::unordered_map<std::string, std::vector<HandlerLink*>> _handlersMap;
+    std::vector<HandlerLink*> _dispatching;
     std::queue<std::unique_ptr<Event>> _eventsQ;
     std::unordered_map<std::string, std::any> _eventDataMap;
 };
@@ -172,3 +355,32 @@ template<typename T>
 auto awaitEvent(std::string_view eventName) {
     return EventScheduler::EventAwaiter<T>(EventScheduler::getInstance(), eventName);
 }
+
+template<typename Rep, typename Period>
+auto sleepFor(std::chrono::duration<Rep, Period> duration) {
+    return EventScheduler::getInstance().sleepFor(duration);
+}
+
+inline auto offloadBlocking() {
+    return EventScheduler::getInstance().offloadBlocking();
+}
+
+inline auto resumeOnCpu() {
+    return EventScheduler::getInstance().resumeOnCpu();
+}
+
+inline auto offloadBlocking(Executor& executor) {
+    return EventScheduler::BlockingAwaiter(executor);
+}
+
+inline auto resumeOnCpu(Executor& executor) {
+    return EventScheduler::CpuAwaiter(executor);
+}
+
+inline auto yieldNow() {
+    return EventScheduler::YieldAwaiter(false);
+}
+
+inline auto maybeYield() {
+    return EventScheduler::YieldAwaiter(true);
+}
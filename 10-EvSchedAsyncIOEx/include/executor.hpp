@@ -1,16 +1,48 @@
 #pragma once
 #include <queue>
+#include <deque>
 #include <functional>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <limits>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <span>
+#include <optional>
 #include "mpmc_queue.hpp"
+#include "bounded_mpmc_queue.hpp"
+#include "event_count.hpp"
+#include "ws_deque.hpp"
+#include "cpu_topology.hpp"
+#include "inline_task.hpp"
+#include "deadline_queue.hpp"
+#include "timer_wheel.hpp"
+#include "latency_histogram.hpp"
+#include "blocking_pool.hpp"
+#include "resume_queue.hpp"
+
+// Bytes of lambda capture stored inside Executor::Task before it spills to the
+// heap. 48 keeps a Task (callable + ops pointer + priority) at one cache line.
+#ifndef EXECUTOR_TASK_INLINE_CAPACITY
+#define EXECUTOR_TASK_INLINE_CAPACITY 48
+#endif
+
+// Per-task wait and run time histograms, see Executor::latencyStats(). Off by
+// default: every task then carries a timestamp and the worker reads the clock twice.
+#ifndef EXECUTOR_LATENCY_HISTOGRAMS
+#define EXECUTOR_LATENCY_HISTOGRAMS 0
+#endif
 
 class Executor {
  public:
-    using Func = std::function<void()>;
+    using Func = InlineTask<EXECUTOR_TASK_INLINE_CAPACITY>;
 
     //Add priority levels for Task
     enum class Priority : uint8_t {
@@ -20,9 +52,14 @@ class Executor {
         kNumPriorities = 3
     };
 
+    //Move-only, captures up to EXECUTOR_TASK_INLINE_CAPACITY bytes don't allocate
     struct Task {
-        std::function<void()> func;
+        Func func;
         Priority priority{Priority::Normal};
+        uint32_t enqueuedUs{0}; //sampled enqueue time (steady clock, wraps), 0 when not sampled
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        int64_t enqueuedNs{0};  //enqueue time of every task (steady clock)
+#endif
 
         Task(Func f, Priority p = Priority::Normal)
               : func(std::move(f)), priority(p) {}
@@ -30,21 +67,99 @@ class Executor {
               void operator() () { func(); }
     };
    
+    //What schedule() does with a task whose priority level is at capacity
+    enum class OverflowPolicy : uint8_t {
+        Block = 0,     //the producer waits for room, a worker thread runs the task inline instead
+        Reject = 1,    //the task is dropped and schedule() returns Admission::Rejected
+        RunInline = 2, //the caller runs the task itself
+        ShedLow = 3    //Low tasks are dropped while any level is full, higher levels block
+    };
+
+    //Outcome of a submission
+    enum class Admission : uint8_t {
+        Queued = 0,
+        Rejected = 1,
+        RanInline = 2,
+        Shed = 3
+    };
+
+    //Where worker threads run
+    enum class Placement : uint8_t {
+        Unpinned = 0, //let the OS schedule them
+        Compact = 1,  //pin worker i to the i-th CPU, filling one NUMA node before the next
+        Spread = 2    //pin workers round robin across NUMA nodes
+    };
+
     struct Config {
+        // Default to the CPUs the process can really use, affinity mask and cgroup
+        // quota included (CpuTopology::limits()), and half of that
         size_t threadCount;
         size_t minThreads;
         size_t tasksPerThreadThreshold;
         std::chrono::seconds keepAliveTime;
         bool enableWorkStealing{true};
+        bool enableStealHalf{true}; //a steal claims up to half the victim's deque at once
+        Placement placement{Placement::Unpinned};
+        // Idle policy: an idle worker polls with cpu pause for idleSpinIterations,
+        // then yields idleYieldIterations times, then parks. Spinning buys wake-up
+        // latency with CPU, set both to 0 to park straight away.
+        size_t idleSpinIterations{256};
+        size_t idleYieldIterations{8};
+        // Share of dequeues each backlogged priority level gets from the global
+        // queues (High, Normal, Low). Every level with a non-zero weight has
+        // bounded latency, a weight of 0 gets no guaranteed share.
+        std::array<size_t, static_cast<size_t>(Priority::kNumPriorities)> priorityWeights{16, 4, 1};
+        // Timer wheel resolution, timers fire on the first tick at or after their time
+        std::chrono::steady_clock::duration timerTick{std::chrono::milliseconds(1)};
+        // Adaptive scaling, re-evaluated by a controller thread every scalingInterval
+        // from sampled queue wait and the share of busy workers. Grow while tasks wait at least scaleUpWait
+        // with workers at least scaleUpUtilization busy. Shrink once wait and
+        // utilization stay under the scaleDown limits for scaleDownChecks checks in a
+        // row. Between the two bands the pool holds, and no change is made within
+        // scalingCooldown of the last one. keepAliveTime still retires parked workers.
+        std::chrono::milliseconds scalingInterval{10};
+        std::chrono::microseconds scaleUpWait{1000};
+        double scaleUpUtilization{0.85};
+        std::chrono::microseconds scaleDownWait{100};
+        double scaleDownUtilization{0.3};
+        size_t scaleDownChecks{20};
+        std::chrono::milliseconds scalingCooldown{100};
+        // Standby: up to standbyThreads threads wait parked in free worker slots, so
+        // growing the pool wakes one rather than creating a thread. A worker that
+        // leaves the pool parks as standby while there is room, else it exits. The
+        // controller creates replacements, never a submitting thread.
+        size_t standbyThreads{2};
+        // Cooperative time slice: a task that has run this long is told to give way at
+        // its next yield point (shouldYield(), co_await maybeYield()). 0 disables it.
+        std::chrono::microseconds timeSlice{0};
+        // Admission control: at most queueCapacity[p] tasks of level p queued at once
+        // (High, Normal, Low), 0 leaves the level unbounded. A bounded level keeps its
+        // global queue in a fixed ring, beyond capacity overflowPolicy decides.
+        std::array<size_t, static_cast<size_t>(Priority::kNumPriorities)> queueCapacity{0, 0, 0};
+        OverflowPolicy overflowPolicy{OverflowPolicy::Block};
+        // LIFO slot: the last task a worker schedules runs next on that worker,
+        // ahead of its queue, while the data it was handed is still in cache. Another
+        // worker with nothing else to run takes it only once it has sat there for a
+        // short grace period, the owner being stuck in a long task. After
+        // lifoSlotBudget slot runs in a row the worker takes one task from its
+        // queues, so ping-pong chains can't starve them. 0 disables the slot.
+        size_t lifoSlotBudget{3};
+        // Blocking pool (scheduleBlocking, co_await offloadBlocking()): threads are
+        // added on demand up to maxBlockingThreads, apart from threadCount, and
+        // leave after keepAliveTime idle. None exist until blocking work arrives.
+        // Defaults to 8 per usable CPU, at least 16: they mostly wait on I/O, but
+        // the CPU they use counts against the same quota.
+        size_t maxBlockingThreads;
         size_t initialTaskPoolSize = 256; 
         size_t batchExecutorTaskBatchSize = 512;
 
         Config()
-        : threadCount(std::thread::hardware_concurrency()),
-          minThreads(std::thread::hardware_concurrency()/ 2),
+        : threadCount(CpuTopology::limits().usableCpus),
+          minThreads(CpuTopology::limits().usableCpus / 2),
           tasksPerThreadThreshold(3),
           keepAliveTime(std::chrono::seconds(60)),
-          enableWorkStealing(true) {}
+          enableWorkStealing(true),
+          maxBlockingThreads(std::max<size_t>(CpuTopology::limits().usableCpus * 8, 16)) {}
     };
     
     explicit Executor(const Config& config = Config{}) 
@@ -53,51 +168,410 @@ class Executor {
       _minThreads(config.minThreads),
       _maxThreads(config.threadCount),
       _activeThreads(0),
+      _timers(config.timerTick),
+      _blockingPool(config.maxBlockingThreads, config.keepAliveTime),
       _pendingTasks(0),
+      _resumeQ(config.threadCount),
       _taskPoolSize(config.initialTaskPoolSize),
-      _config(config) {}
+      _config(config),
+      _bounded(std::any_of(config.queueCapacity.begin(), config.queueCapacity.end(),
+                           [](size_t capacity) { return capacity > 0; })) {}
 
-    ~Executor() {
+    virtual ~Executor() {
         if (!stopped) stop();
     }
 
-    void schedule(Func task, Priority priority = Priority::Normal) {
-        if (stopped) return;
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            
-            //Resize task queue if necessary
-            checkTaskQueueResize();
-
-            //Try to add to localQ if called from worker thread
-            if (_config.enableWorkStealing && currentThreadId < _localQVec.size()) {
-                _localQVec[currentThreadId]->push(Task(std::move(task), priority));
-            } else {
-                _taskQArray[static_cast<size_t>(priority)]->push(Task(std::move(task), priority));
+    struct ScalingDecision {
+        enum class Action : uint8_t { ScaleUp, ScaleDown };
+
+        std::chrono::steady_clock::time_point at;
+        Action action;
+        size_t threadsBefore;
+        size_t pendingTasks;
+        std::chrono::microseconds queueWait; //mean sampled wait over the last interval
+        double utilization;                  //smoothed share of busy workers
+    };
+
+    struct ScalingStats {
+        size_t scaleUps{0};
+        size_t scaleDowns{0};
+        size_t idleRetirements{0}; //workers that left after keepAliveTime parked
+        size_t standbyActivations{0}; //workers that joined the pool from standby
+        size_t threadsCreated{0};
+        size_t standby{0};             //parked standby workers now
+        std::vector<ScalingDecision> recent; //oldest first, at most kScalingHistory
+    };
+
+    static constexpr size_t kScalingHistory = 32;
+
+    // Per priority level, queued is only counted on bounded levels
+    struct AdmissionStats {
+        size_t queued{0};
+        size_t blocked{0};   //submissions that waited for room
+        size_t rejected{0};
+        size_t ranInline{0};
+        size_t shed{0};
+    };
+
+    // Queue wait (enqueue to dequeue) and run time (dequeue to completion) in ns,
+    // per priority level, merged over all workers
+    struct LatencyStats {
+        std::array<LatencySummary, static_cast<size_t>(Priority::kNumPriorities)> wait;
+        std::array<LatencySummary, static_cast<size_t>(Priority::kNumPriorities)> run;
+    };
+
+    static constexpr bool kLatencyHistograms = EXECUTOR_LATENCY_HISTOGRAMS != 0;
+
+    struct StealStats {
+        size_t attempts{0};    //victim queues probed
+        size_t successes{0};   //probes that got at least one task
+        size_t tasksStolen{0}; //tasks moved, > successes with steal half
+    };
+
+    // Lock free submission: no mutex unless the pool has no running worker yet.
+    // Queue growth happens inside MPMCQueue, scale up is decided by the controller thread.
+    // With bounded levels a full level applies Config::overflowPolicy.
+    Admission schedule(Func task, Priority priority = Priority::Normal) {
+        return schedule(Task(std::move(task), priority));
+    }
+
+    // Virtual so executors with their own queues (ShardedExecutor) can route
+    virtual Admission schedule(Task task) {
+        if (stopped) return Admission::Rejected;
+        if (_bounded) {
+            auto admission = admit(task);
+            if (admission != Admission::Queued) return admission;
+        }
+
+        //Count first so workers never see more tasks than _pendingTasks
+        _pendingTasks.fetch_add(1, std::memory_order_relaxed);
+        sampleEnqueue(task);
+
+        //From one of our workers the task takes the LIFO slot, the one it displaces
+        //goes to the local deque. A fresh slot task only wakes someone when no idle
+        //worker is still searching: chains of hops mostly run on this worker, and
+        //the slot isn't stealable until kLifoStealGraceNs has passed anyway.
+        if (onOwnWorker() && _config.lifoSlotBudget > 0) {
+            if (!swapLifo(task)) {
+                if (_searchingWorkers.load(std::memory_order_relaxed) == 0) onTaskQueued();
+                return Admission::Queued;
             }
-            _pendingTasks++;
+        }
 
-            //Scale up if needed
-            if (shouldScaleUp()) { addThread(); }
+        //Try to add to localQ if called from one of our worker threads
+        if (_config.enableWorkStealing && isWorkerThread()) {
+            localQueue(static_cast<size_t>(task.priority)).push(std::move(task));
+        } else {
+            pushGlobal(std::move(task));
         }
-        _cv.notify_one();
+
+        onTaskQueued();
+        return Admission::Queued;
+    }
+
+    // Bulk submission, tasks are moved out of the range. One _pendingTasks update,
+    // one publish per queue and one wake-up round for min(n, parked) workers.
+    // Each run of equal priority is published at once: from a worker onto its own
+    // deque for that level, where thieves spread it, from outside into the global queue.
+    // On bounded levels what fits goes in bulk, the rest through schedule() one by one.
+    template<typename It>
+    void scheduleBatch(It first, It last) {
+        if (stopped || first == last) return;
+        if (!_bounded) {
+            enqueueBatch(first, last);
+            return;
+        }
+
+        while (first != last) {
+            auto priority = first->priority;
+            auto runEnd = std::find_if(std::next(first), last,
+                [priority](const Task& task) { return task.priority != priority; });
+            auto fits = std::next(first, reserveSlots(static_cast<size_t>(priority),
+                                                      static_cast<size_t>(std::distance(first, runEnd))));
+            enqueueBatch(first, fits);
+            for (; fits != runEnd; ++fits) schedule(std::move(*fits));
+            first = runEnd;
+        }
+    }
+
+    void scheduleBatch(std::span<Task> tasks) {
+        scheduleBatch(tasks.begin(), tasks.end());
+    }
+
+    // Executor whose worker is running the calling thread, nullptr elsewhere
+    static Executor* current() { return currentExecutor; }
+
+    // True once the running task has used up Config::timeSlice. Long tasks poll it
+    // and requeue their remaining work with yieldTask().
+    static bool shouldYield() {
+        Executor* executor = currentExecutor;
+        if (!executor || executor->_config.timeSlice.count() == 0) return false;
+        return std::chrono::steady_clock::now() - sliceStart >= executor->_config.timeSlice;
+    }
+
+    // Continuation of the running task, queued at the back of its priority level.
+    // Never goes to the local deque, whose LIFO pop would hand it straight back.
+    // Admitted past a full level, the task it continues already held a slot.
+    // False once stopped, the continuation is dropped and the caller runs it.
+    bool yieldTask(Func continuation) {
+        return yieldTask(std::move(continuation), runningPriority);
+    }
+
+    bool yieldTask(Func continuation, Priority priority) {
+        if (stopped) return false;
+
+        Task task(std::move(continuation), priority);
+        forceAdmit(task.priority);
+        _pendingTasks.fetch_add(1, std::memory_order_relaxed);
+        sampleEnqueue(task);
+        pushGlobal(std::move(task));
+        if (isWorkerThread()) WorkerCounters::add(_workerCounters[currentThreadId].yields, 1);
+        onTaskQueued();
+        return true;
+    }
+
+    // Runs one queued task on the calling worker, so a task waiting on work it
+    // spawned itself (parallel_for) helps instead of holding its thread idle.
+    // False off the pool or when nothing is ready.
+    virtual bool runPendingTask() {
+        if (!isWorkerThread()) return false;
+        NestedRun outer;
+        Task task([] {});
+        if (!getNextTask(task)) return false;
+        recordQueueWait(task);
+        executeTask(task);
+        return true;
+    }
+
+    // Resumes count coroutines given as ResumeNodes linked through next. The nodes
+    // live in the awaiters, so this allocates nothing, and workers take them ahead
+    // of their local deque. A worker queues them on its own resume shard, other
+    // threads on a random one. Past admission control like yields and timers, the
+    // suspended coroutine already held a slot. False once stopped, the caller
+    // resumes them itself.
+    bool scheduleResume(ResumeNode& first, size_t count = 1) {
+        if (stopped) return false;
+        _pendingTasks.fetch_add(count, std::memory_order_relaxed);
+        _resumeQ.push(first, count, onOwnWorker() ? currentThreadId : nextStealRandom());
+        onTaskQueued(count);
+        return true;
+    }
+
+    // Runs task on the blocking pool instead of a CPU worker, for work that sleeps
+    // or waits on I/O. Rejected once stopped.
+    Admission scheduleBlocking(Func task) {
+        if (stopped || !_blockingPool.post(task)) return Admission::Rejected;
+        return Admission::Queued;
+    }
+
+    // True on a thread of this executor's blocking pool
+    bool onBlockingThread() const { return _blockingPool.runningInThisThread(); }
+
+    using BlockingStats = BlockingPool<Func>::Stats;
+
+    BlockingStats blockingStats() const { return _blockingPool.stats(); }
+
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    // Deadline class: runs ahead of the priority queues, earliest deadline first.
+    // Completion is checked against the deadline and recorded in deadlineStats().
+    void scheduleWithDeadline(Func task, Deadline deadline) {
+        if (stopped) return;
+
+        _pendingTasks.fetch_add(1, std::memory_order_relaxed);
+        Task deadlineTask(std::move(task));
+        sampleEnqueue(deadlineTask);
+        _deadlineQ.push(deadline, std::move(deadlineTask));
+        onTaskQueued();
+    }
+
+    template<typename Rep, typename Period>
+    void scheduleWithDeadline(Func task, std::chrono::duration<Rep, Period> budget) {
+        scheduleWithDeadline(std::move(task),
+            std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget));
+    }
+
+    using TimerId = TimerWheel<Task>::TimerId;
+    static constexpr TimerId kInvalidTimer = TimerWheel<Task>::kInvalidTimer;
+
+    // Timers: a hierarchical wheel driven by one timer thread, started on first use.
+    // Insert and cancel are O(1), each tick's expired tasks go to the priority queues
+    // together. A time already passed schedules the task now and returns kInvalidTimer.
+    TimerId scheduleAt(Deadline when, Func task, Priority priority = Priority::Normal) {
+        TimerId id = kInvalidTimer;
+        addTimer(when, Task(std::move(task), priority), id);
+        return id;
+    }
+
+    // scheduleAt() for callers that can't afford to lose the task (SleepAwaiter).
+    // False when it will never run: the executor is stopped, or the task was due
+    // already and its level turned it away.
+    bool tryScheduleAt(Deadline when, Func task, Priority priority = Priority::Normal) {
+        TimerId id = kInvalidTimer;
+        auto admission = addTimer(when, Task(std::move(task), priority), id);
+        return admission != Admission::Rejected && admission != Admission::Shed;
+    }
+
+    template<typename Rep, typename Period>
+    TimerId scheduleAfter(std::chrono::duration<Rep, Period> delay, Func task, Priority priority = Priority::Normal) {
+        return scheduleAt(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay),
+                          std::move(task), priority);
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancelTimer(TimerId id) {
+        std::lock_guard<std::mutex> lock(_timerMutex);
+        return _timers.cancel(id);
+    }
+
+    size_t pendingTimers() {
+        std::lock_guard<std::mutex> lock(_timerMutex);
+        return _timers.size();
     }
 
     void start() {
          createThreadPool(_minThreads); //Start with min threads
     }
 
+    StealStats stealStats() const {
+        StealStats stats;
+        for (size_t i = 0; _workerCounters && i < _workerSlots; ++i) {
+            stats.attempts += _workerCounters[i].attempts.load(std::memory_order_relaxed);
+            stats.successes += _workerCounters[i].successes.load(std::memory_order_relaxed);
+            stats.tasksStolen += _workerCounters[i].tasksStolen.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    struct IdleStats {
+        std::chrono::nanoseconds spinning{0};
+        std::chrono::nanoseconds yielding{0};
+        std::chrono::nanoseconds parked{0};
+        size_t parks{0};
+        size_t taskYields{0}; //continuations requeued through yieldTask()
+    };
+
+    std::array<AdmissionStats, static_cast<size_t>(Priority::kNumPriorities)> admissionStats() const {
+        std::array<AdmissionStats, static_cast<size_t>(Priority::kNumPriorities)> stats;
+        for (size_t p = 0; p < stats.size(); ++p) {
+            auto& level = _levels[p];
+            stats[p] = {level.queued.load(std::memory_order_relaxed),
+                        level.blocked.load(std::memory_order_relaxed),
+                        level.rejected.load(std::memory_order_relaxed),
+                        level.ranInline.load(std::memory_order_relaxed),
+                        level.shed.load(std::memory_order_relaxed)};
+        }
+        return stats;
+    }
+
+    // Empty unless built with EXECUTOR_LATENCY_HISTOGRAMS
+    LatencyStats latencyStats() const {
+        LatencyStats stats;
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        for (size_t i = 0; _workerLatency && i < _workerSlots; ++i) {
+            for (size_t p = 0; p < stats.wait.size(); ++p) {
+                _workerLatency[i].wait[p].mergeInto(stats.wait[p]);
+                _workerLatency[i].run[p].mergeInto(stats.run[p]);
+            }
+        }
+#endif
+        return stats;
+    }
+
+    // Lateness buckets for missed deadlines: <100us, <1ms, <10ms, <100ms, <1s, >=1s
+    static constexpr size_t kLatenessBuckets = 6;
+
+    struct DeadlineStats {
+        size_t met{0};
+        size_t missed{0};
+        std::array<size_t, kLatenessBuckets> missLateness{};
+
+        static constexpr std::array<const char*, kLatenessBuckets> bucketLabels{
+            "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"};
+    };
+
+    DeadlineStats deadlineStats() const {
+        DeadlineStats stats;
+        for (size_t i = 0; _workerCounters && i < _workerSlots; ++i) {
+            auto& counters = _workerCounters[i];
+            stats.met += counters.deadlinesMet.load(std::memory_order_relaxed);
+            stats.missed += counters.deadlinesMissed.load(std::memory_order_relaxed);
+            for (size_t b = 0; b < kLatenessBuckets; ++b) {
+                stats.missLateness[b] += counters.missLateness[b].load(std::memory_order_relaxed);
+            }
+        }
+        return stats;
+    }
+
+    // One entry per worker slot
+    std::vector<IdleStats> idleStats() const {
+        std::vector<IdleStats> stats;
+        for (size_t i = 0; _workerCounters && i < _workerSlots; ++i) {
+            auto& counters = _workerCounters[i];
+            stats.push_back({
+                std::chrono::nanoseconds(counters.spinNanos.load(std::memory_order_relaxed)),
+                std::chrono::nanoseconds(counters.yieldNanos.load(std::memory_order_relaxed)),
+                std::chrono::nanoseconds(counters.parkedNanos.load(std::memory_order_relaxed)),
+                counters.parks.load(std::memory_order_relaxed),
+                counters.yields.load(std::memory_order_relaxed)});
+        }
+        return stats;
+    }
+
+    ScalingStats scalingStats() {
+        std::unique_lock<std::mutex> lock(_scalingMutex);
+        ScalingStats stats;
+        stats.scaleUps = _scaling.scaleUps;
+        stats.scaleDowns = _scaling.scaleDowns;
+        stats.idleRetirements = _idleRetirements.load(std::memory_order_relaxed);
+        stats.recent.assign(begin(_scaling.history), end(_scaling.history));
+        lock.unlock();
+
+        std::lock_guard<std::mutex> poolLock(_mutex);
+        stats.standbyActivations = _standbyActivations;
+        stats.threadsCreated = _threadsCreated;
+        stats.standby = _standbySlots.size();
+        return stats;
+    }
+
+    size_t activeThreads() const { return _activeThreads.load(std::memory_order_relaxed); }
+
+    size_t maxThreads() const { return _maxThreads; }
+
+    //Queued and not yet taken by a worker. Subclasses with queues of their own add them in.
+    virtual size_t pendingTasks() const { return _pendingTasks.load(std::memory_order_relaxed); }
+
+    bool isStopped() const { return stopped; }
+
     void stop() {
         {
             std::lock_guard<std::mutex> lock(_mutex);
             stopped = true;
+            for (size_t slot : _standbySlots) _standby[slot].cv.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_timerMutex);
+            _timersStopped = true;
         }
-        _cv.notify_all();
+        _timerCv.notify_one();
+        if (_timerThread.joinable()) _timerThread.join();
+        {
+            std::lock_guard<std::mutex> lock(_controllerMutex);
+            _controllerStopped = true;
+        }
+        _controllerCv.notify_one();
+        if (_controllerThread.joinable()) _controllerThread.join();
+
+        wakeWorkers(std::numeric_limits<size_t>::max());
+        for (auto& level : _levels) level.space.notifyAll(); //blocked producers give up
 
         for (auto& thread : _threadsVec) {
             if (thread.joinable()) thread.join();
         }
         _threadsVec.clear();
+
+        //Last, blocking work already queued still runs and can't hop back to the CPU pool
+        _blockingPool.stop();
     }
 
  private:
@@ -114,75 +588,352 @@ class Executor {
         for (auto& queue : _taskQArray) {
             queue = std::make_unique<MPMCQueue<Task>>(queueSize);
         }
+        for (size_t p = 0; p < _boundedQArray.size(); ++p) {
+            if (_config.queueCapacity[p] > 0) _boundedQArray[p] = std::make_unique<BoundedMPMCQueue<Task>>(_config.queueCapacity[p]);
+        }
+
+        // Worker slots are allocated once for _maxThreads so workers can index
+        // _localQVec without the lock, exited slots get reused by addThread()
+        size_t slotCount = std::max(_maxThreads, static_cast<size_t>(1));
+        _threadsVec.resize(slotCount);
+        _slotExited = std::make_unique<std::atomic<bool>[]>(slotCount);
+        _workerCounters = std::make_unique<WorkerCounters[]>(slotCount);
+        _lifoSlots = std::make_unique<LifoSlot[]>(slotCount);
+        _lifoSightings = std::make_unique<LifoSighting[]>(slotCount * slotCount);
+        _standby = std::make_unique<Standby[]>(slotCount);
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        _workerLatency = std::make_unique<WorkerLatency[]>(slotCount);
+#endif
+        _workerSlots = slotCount;
+        for (size_t i = 0; i < slotCount; ++i) _slotExited[i] = true;
+
+        // Pinned placement: fix each slot's CPU and node up front, steals prefer the same node
+        if (_config.placement != Placement::Unpinned) {
+            auto topology = CpuTopology::detect();
+            auto order = topology.placementOrder(_config.placement == Placement::Spread);
+            _numaNodes = topology.nodeCount();
+            _slotCpu.resize(slotCount);
+            _slotNode.resize(slotCount);
+            for (size_t i = 0; i < slotCount; ++i) {
+                _slotCpu[i] = order[i % order.size()].id;
+                _slotNode[i] = order[i % order.size()].node;
+            }
+        }
 
         // Initialize local queues for work stealing
         if (_config.enableWorkStealing) {
-            _localQVec.reserve(thread_count);
-            for (size_t i = 0; i< thread_count; ++i) { 
-                _localQVec.emplace_back(std::make_unique<MPMCQueue<Task>>(queueSize / thread_count));
+            _localQVec.resize(slotCount);
+            for (auto& levels : _localQVec) {
+                for (auto& deque : levels) deque = std::make_unique<WorkStealingDeque<Task>>(queueSize / slotCount);
             }
         }
 
-        //Create worker threads
-        for (size_t i = 0; i < thread_count; ++i) {
-            _threadsVec.emplace_back([this, i] () { 
-                currentThreadId = i;
-                run();
-            });
+        //Create worker threads, then park standby ones in the slots left over
+        for (size_t i = 0; i < std::min(thread_count, slotCount); ++i) {
+            spawnWorker(i);
+        }
+        replenishStandby();
+
+        //A fixed size pool has nothing to decide
+        if (_minThreads < _maxThreads) _controllerThread = std::thread([this] { runController(); });
+    }
+
+    // Caller holds _mutex. A standby worker starts parked, activateStandby() lets it in.
+    void spawnWorker(size_t slot, bool standby = false) {
+        _slotExited[slot] = false;
+        if (standby) {
+            _standby[slot].activated = false;
+            _standbySlots.push_back(slot);
+        } else {
             _activeThreads++;
         }
+        try {
+            _threadsVec[slot] = std::thread([this, slot, standby] () {
+                currentExecutor = this;
+                currentThreadId = slot;
+                stealRandState = (slot + 1) * 0x9E3779B97F4A7C15ull;
+                if (!_slotCpu.empty()) {
+                    CpuTopology::pinCurrentThread(_slotCpu[slot]);
+                    if (_config.enableWorkStealing) {
+                        for (auto& deque : _localQVec[slot]) deque->rehome();
+                    }
+                }
+                bool active = !standby;
+                if (standby) {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    active = waitActivated(lock, slot);
+                }
+                //run() returns once the worker has left the pool
+                while (active) {
+                    run();
+                    active = parkStandby(slot);
+                }
+                _slotExited[slot].store(true, std::memory_order_release);
+            });
+            ++_threadsCreated;
+        } catch (...) {
+            if (standby) _standbySlots.pop_back();
+            else _activeThreads--;
+            _slotExited[slot] = true;
+            throw;
+        }
+    }
+
+    // After leaving the pool: stay parked in the slot while standby has room. True
+    // once activated again, false when the thread should exit.
+    bool parkStandby(size_t slot) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (stopped || _standbySlots.size() >= _config.standbyThreads) return false;
+        _standby[slot].activated = false;
+        _standbySlots.push_back(slot);
+        return waitActivated(lock, slot);
+    }
+
+    bool waitActivated(std::unique_lock<std::mutex>& lock, size_t slot) {
+        auto& standby = _standby[slot];
+        standby.cv.wait(lock, [&] { return standby.activated || stopped; });
+        if (standby.activated) return true; //stopped meanwhile, run() leaves straight away
+        std::erase(_standbySlots, slot);
+        return false;
+    }
+
+    // Caller holds _mutex. Counts the worker in before it runs, so it can't be
+    // activated twice. False when nothing is parked.
+    bool activateStandby() {
+        if (_standbySlots.empty() || stopped) return false;
+        size_t slot = _standbySlots.back();
+        _standbySlots.pop_back();
+        _activeThreads++;
+        ++_standbyActivations;
+        _standby[slot].activated = true;
+        _standby[slot].cv.notify_one();
+        return true;
+    }
+
+    // Caller holds _mutex. New threads go straight to standby in free slots.
+    void replenishStandby() {
+        for (size_t slot = 0; slot < _workerSlots && _standbySlots.size() < _config.standbyThreads; ++slot) {
+            if (stopped) return;
+            if (!_slotExited[slot].load(std::memory_order_acquire)) continue;
+            if (!reuseSlot(slot, true)) return;
+        }
+    }
+
+    // Caller holds _mutex. The slot's previous thread has exited, its deque, LIFO
+    // slot and counters carry over to the new one.
+    bool reuseSlot(size_t slot, bool standby) {
+        try {
+            if (_threadsVec[slot].joinable()) _threadsVec[slot].join();
+            spawnWorker(slot, standby);
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr<<" Failed to create thread " << e.what() << std::endl;
+            return false;
+        }
     }
     
     virtual bool getNextTask(Task& task) {
-        //First try local Q
-        if (_config.enableWorkStealing && currentThreadId < _localQVec.size()) {
-            if (_localQVec[currentThreadId]->try_pop(task)) {
-                _pendingTasks--;
-                return true;
+        //Deadline tasks are the most urgent
+        if (popDeadlineTask(task)) return true;
+
+        //Then what this worker just scheduled, while the slot's budget lasts
+        if (popLifoTask(task, true)) {
+            taskDequeued(task);
+            return true;
+        }
+
+        //Then coroutines waiting to continue
+        if (popResumeTask(task)) return true;
+
+        //Own deques and the global queues, weighted across priority levels
+        if (popQueuedTask(task)) return true;
+
+        if (tryStealTask(task)) return true;
+
+        //Nothing else to run, the budget doesn't apply
+        if (popLifoTask(task, false)) {
+            taskDequeued(task);
+            return true;
+        }
+        return stealLifoTask(task);
+    }
+
+    bool waitForTask(Task& task) {
+        if (getNextTask(task)) return true;
+
+        //Idle: spin, then yield, then park. Each phase's time goes to this worker's counters.
+        auto& counters = _workerCounters[currentThreadId];
+        IdleScope idle(_idleWorkers);
+        auto phaseStart = std::chrono::steady_clock::now();
+        {
+            IdleScope searching(_searchingWorkers);
+            for (size_t i = 0; i < _config.idleSpinIterations && !stopped; ++i) {
+                cpuRelax();
+                if (_pendingTasks.load(std::memory_order_relaxed) > 0 && getNextTask(task)) {
+                    WorkerCounters::addIdle(counters.spinNanos, phaseStart);
+                    return true;
+                }
+            }
+            phaseStart = WorkerCounters::addIdle(counters.spinNanos, phaseStart);
+
+            for (size_t i = 0; i < _config.idleYieldIterations && !stopped; ++i) {
+                std::this_thread::yield();
+                if (getNextTask(task)) {
+                    WorkerCounters::addIdle(counters.yieldNanos, phaseStart);
+                    return true;
+                }
             }
+            phaseStart = WorkerCounters::addIdle(counters.yieldNanos, phaseStart);
         }
 
-        //Get task from global q
-        for (size_t p = 0; p < static_cast<size_t>(Priority::kNumPriorities); ++p) {
-            if(_taskQArray[p]->try_pop(task)) {
-                _pendingTasks--;
+        auto deadline = phaseStart + _keepAliveTime;
+        bool graceWaited = false;
+        while (!stopped) {
+            if (getNextTask(task)) {
+                WorkerCounters::addIdle(counters.parkedNanos, phaseStart);
+                return true;
+            }
+
+            //Idle workers are the ones to leave when the controller asks for one fewer
+            if (claimRetireRequest()) {
+                WorkerCounters::addIdle(counters.parkedNanos, phaseStart);
+                return false;
+            }
+
+            //Announce we are parking, then re-check so a racing schedule() isn't missed
+            auto key = _eventCount.prepareWait();
+            if (getNextTask(task)) {
+                _eventCount.cancelWait();
+                WorkerCounters::addIdle(counters.parkedNanos, phaseStart);
                 return true;
             }
+            if (stopped) {
+                _eventCount.cancelWait();
+                break;
+            }
+
+            //A slot task in its grace period: once it is over, come back for it if
+            //the owner still hasn't. Once per wake-up, finding a newer one instead
+            //means the owner is getting through them. Still searching meanwhile,
+            //so further slot fills don't wake us.
+            if (lifoGraceEnd != 0 && !graceWaited) {
+                graceWaited = true;
+                IdleScope searching(_searchingWorkers);
+                _eventCount.waitUntil(key, Deadline(std::chrono::nanoseconds(lifoGraceEnd)));
+                continue;
+            }
+
+            //Slot fills made while we counted as searching woke nobody, so with
+            //one still young look again now and then in case its owner got stuck
+            auto parkUntil = deadline;
+            if (lifoGraceEnd != 0) parkUntil = std::min(deadline, std::chrono::steady_clock::now() + kLifoRecheck);
+
+            WorkerCounters::add(counters.parks, 1);
+            if (_eventCount.waitUntil(key, parkUntil)) {
+                graceWaited = false;
+            } else if (parkUntil == deadline) {
+                //Handle timeout -scale down if idle
+                if (tryRetire()) {
+                    _idleRetirements.fetch_add(1, std::memory_order_relaxed);
+                    WorkerCounters::addIdle(counters.parkedNanos, phaseStart);
+                    return false;
+                }
+                deadline = std::chrono::steady_clock::now() + _keepAliveTime;
+            }
         }
-        return tryStealTask(task);
+
+        WorkerCounters::addIdle(counters.parkedNanos, phaseStart);
+        decrementActiveThreads();
+        return false; //stopped
     }
 
-    bool waitForTask(Task& task) {
-        bool hasTask = false;
-        std::unique_lock<std::mutex> lock(_mutex);
-        
-        //Wait for timeout or stopped || hasTask to be true
-        if(_cv.wait_for(lock, _keepAliveTime, [this, &task, &hasTask] {
-                    hasTask = getNextTask(task);
-                    return stopped || hasTask; 
-            })) {
-                //either stopped == true or hasTask == true or both
-                if (stopped) {
-                    decrementActiveThreads();
-                    return false; //don't wait for task
+
+    void recordDeadline(Deadline deadline) {
+        auto& counters = _workerCounters[currentThreadId];
+        auto now = std::chrono::steady_clock::now();
+        if (now <= deadline) {
+            WorkerCounters::add(counters.deadlinesMet, 1);
+            return;
+        }
+
+        WorkerCounters::add(counters.deadlinesMissed, 1);
+        auto lateUs = std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count();
+        size_t bucket = 0;
+        for (long long limit = 100; bucket + 1 < kLatenessBuckets && lateUs >= limit; limit *= 10) ++bucket;
+        WorkerCounters::add(counters.missLateness[bucket], 1);
+    }
+
+    // Common tail of every submission path
+    void onTaskQueued(size_t count = 1) {
+        wakeWorkers(count);
+
+        //Slow path: pool is empty (minThreads == 0 or everyone timed out). A standby
+        //worker takes it, failing that the controller creates a thread.
+        if (_activeThreads.load(std::memory_order_relaxed) == 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_activeThreads == 0 && !activateStandby()) wakeController();
+        }
+    }
+
+    // On the wheel, or through schedule() when due already or the wheel is full.
+    // id is only set for a task on the wheel.
+    Admission addTimer(Deadline when, Task timerTask, TimerId& id) {
+        if (stopped) return Admission::Rejected;
+        if (when <= std::chrono::steady_clock::now()) return schedule(std::move(timerTask));
+
+        {
+            std::lock_guard<std::mutex> lock(_timerMutex);
+            if (_timersStopped) return Admission::Rejected; //stop() got here first
+            id = _timers.insert(when, timerTask);
+            if (id != kInvalidTimer) {
+                if (!_timerThread.joinable()) {
+                    _timerThread = std::thread([this] { runTimers(); });
+                } else if (when < _timerWakeAt) {
+                    _timerCv.notify_one();
                 }
-               if (hasTask) return true; //hasTask is true
+            }
         }
 
-        //Handle timeout -scale down if idle
-        if (stopped || _activeThreads > _minThreads) { decrementActiveThreads(); }
-        return false;
+        if (id == kInvalidTimer) return schedule(std::move(timerTask));
+        return Admission::Queued;
     }
 
+    // Timer thread: sleep until the earliest slot is due, then hand out everything
+    // that expired in one go. Tasks are scheduled outside the lock so timer calls
+    // from other threads never wait on queue pushes.
+    void runTimers() {
+        std::vector<Task> expired;
+        std::unique_lock<std::mutex> lock(_timerMutex);
+        while (!_timersStopped) {
+            _timers.advance(std::chrono::steady_clock::now(), expired);
+            if (!expired.empty()) {
+                lock.unlock();
+                //Accepted when the timer was set, a full level must not drop or block them
+                for (auto& task : expired) forceAdmit(task.priority);
+                enqueueBatch(expired.begin(), expired.end());
+                expired.clear();
+                lock.lock();
+                continue;
+            }
 
-    void executeTask(Task& task) {
-        try {
-             task(); //run the task
-        } catch (const std::exception& e) { handleTaskError(e); } 
-        catch (...) { handleUnknownError(); }
+            auto next = _timers.nextExpiry();
+            _timerWakeAt = next ? *next : Deadline::max();
+            if (next) _timerCv.wait_until(lock, *next);
+            else _timerCv.wait(lock);
+        }
+        _timerWakeAt = Deadline::max();
     }
 
     void decrementActiveThreads() {  _activeThreads--; }
+
+    // Leave the pool only while it stays above _minThreads
+    bool tryRetire() {
+        size_t active = _activeThreads.load();
+        while (active > _minThreads) {
+            if (_activeThreads.compare_exchange_weak(active, active - 1)) return true;
+        }
+        return false;
+    }
     
     void handleTaskError(const std::exception& e) {
         std::cerr << "Task exception: " << e.what() << std::endl;
@@ -192,91 +943,784 @@ class Executor {
         std::cerr << "Unknown task exception occurred" << std::endl;
     }
 
-    bool shouldScaleUp() const  {
-        const size_t tasksPerThread = _pendingTasks / (_activeThreads + 1);
-        return tasksPerThread > _tasksPerThreadThreshold && 
-               _activeThreads < _maxThreads && _pendingTasks > 0;
+    static uint32_t nowMicros() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
     }
 
-    void addThread() {
-        if (_activeThreads >= _maxThreads) {
-            return;
+    // Controller thread: evaluates scaling every scalingInterval, then tops the
+    // standby workers back up. Thread creation happens here, off the submitting
+    // threads and the workers. wakeController() cuts the wait short.
+    void runController() {
+        auto nextCheck = std::chrono::steady_clock::now() + _config.scalingInterval;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_controllerMutex);
+                _controllerCv.wait_until(lock, nextCheck, [this] { return _controllerStopped || _controllerWake; });
+                if (_controllerStopped) return;
+                _controllerWake = false;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextCheck) {
+                nextCheck = now + _config.scalingInterval;
+                std::lock_guard<std::mutex> lock(_scalingMutex);
+                evaluateScaling(now);
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            //Work arrived while the pool was empty and no standby was parked
+            if (_activeThreads == 0 && _pendingTasks.load(std::memory_order_relaxed) > 0) addThread();
+            replenishStandby();
         }
+    }
 
-        size_t threadId = _localQVec.size();
-        try {
-            _localQVec.emplace_back(std::make_unique<MPMCQueue<Task>>());
-            _threadsVec.emplace_back([this, threadId] {
-                currentThreadId = threadId;
-                run();
-            });
-            _activeThreads++;
-        } catch (const std::exception& e) {
-            std::cerr<<" Failed to create thread " << e.what() << std::endl;
+    void wakeController() {
+        {
+            std::lock_guard<std::mutex> lock(_controllerMutex);
+            _controllerWake = true;
         }
+        _controllerCv.notify_one();
     }
 
-    void checkTaskQueueResize() {
-        if (_pendingTasks <= _taskPoolSize * 0.8)  return;  //80 % threshold
-        
-        size_t newSize = _taskPoolSize << 1;
-        for (size_t p = 0; p < static_cast<size_t>(Priority::kNumPriorities); ++p) {
-            _taskQArray[p]->resizePool(newSize);
+    // Caller holds _scalingMutex
+    void evaluateScaling(std::chrono::steady_clock::time_point now) {
+        size_t active = _activeThreads.load();
+        if (active == 0) return;
+
+        //Mean wait of the tasks sampled since the last check
+        size_t waitSum = 0, samples = 0;
+        for (size_t i = 0; i < _workerSlots; ++i) {
+            waitSum += _workerCounters[i].queueWaitUs.load(std::memory_order_relaxed);
+            samples += _workerCounters[i].queueWaitSamples.load(std::memory_order_relaxed);
         }
+        size_t pending = _pendingTasks.load(std::memory_order_relaxed);
+        std::chrono::microseconds wait{0};
+        if (samples > _scaling.waitSamples) {
+            wait = std::chrono::microseconds((waitSum - _scaling.waitSum) / (samples - _scaling.waitSamples));
+        } else if (pending > active) {
+            //Backlog but nothing sampled got through, it waited the whole interval
+            wait = std::chrono::duration_cast<std::chrono::microseconds>(_config.scalingInterval);
+        }
+        _scaling.waitSum = waitSum;
+        _scaling.waitSamples = samples;
 
-        if (_config.enableWorkStealing) {
-            for (auto& localQ : _localQVec) {
-                localQ->resizePool(newSize / _localQVec.size());
+        size_t idle = std::min(_idleWorkers.load(std::memory_order_relaxed), active);
+        double busy = 1.0 - static_cast<double>(idle) / static_cast<double>(active);
+        _scaling.utilization = _scaling.checks++ == 0 ? busy : 0.75 * _scaling.utilization + 0.25 * busy;
+
+        bool coolingDown = now < _scaling.lastChange + _config.scalingCooldown;
+
+        if (wait >= _config.scaleUpWait && _scaling.utilization >= _config.scaleUpUtilization) {
+            _scaling.quietChecks = 0;
+            _retireRequests.store(0, std::memory_order_relaxed); //a scale down nobody took is stale now
+            if (coolingDown || active >= _maxThreads) return;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            addThread();
+            if (_activeThreads.load() > active) {
+                recordScaling(ScalingDecision::Action::ScaleUp, now, active, pending, wait);
             }
+            return;
         }
 
-        _taskPoolSize = newSize;
+        if (wait > _config.scaleDownWait || _scaling.utilization > _config.scaleDownUtilization) {
+            _scaling.quietChecks = 0; //inside the hysteresis band, hold
+            return;
+        }
+
+        if (++_scaling.quietChecks < _config.scaleDownChecks || coolingDown || active <= _minThreads) return;
+        _scaling.quietChecks = 0;
+        _retireRequests.store(1, std::memory_order_relaxed);
+        _eventCount.notifyOne(); //a parked worker takes it
+        recordScaling(ScalingDecision::Action::ScaleDown, now, active, pending, wait);
+    }
+
+    // Caller holds _scalingMutex
+    void recordScaling(ScalingDecision::Action action, std::chrono::steady_clock::time_point now,
+                       size_t active, size_t pending, std::chrono::microseconds wait) {
+        _scaling.lastChange = now;
+        if (action == ScalingDecision::Action::ScaleUp) ++_scaling.scaleUps;
+        else ++_scaling.scaleDowns;
+
+        if (_scaling.history.size() == kScalingHistory) _scaling.history.pop_front();
+        _scaling.history.push_back({now, action, active, pending, wait, _scaling.utilization});
+    }
+
+    bool claimRetireRequest() {
+        size_t requests = _retireRequests.load(std::memory_order_relaxed);
+        while (requests > 0) {
+            if (_retireRequests.compare_exchange_weak(requests, requests - 1)) return tryRetire();
+        }
+        return false;
+    }
+
+    // Caller holds _mutex. Prefers a standby worker over a new thread.
+    void addThread() {
+        if (stopped || _activeThreads >= _maxThreads || _threadsVec.empty()) {
+            return;
+        }
+        if (activateStandby()) return;
+
+        for (size_t slot = 0; slot < _threadsVec.size(); ++slot) {
+            if (!_slotExited[slot].load(std::memory_order_acquire)) continue;
+            reuseSlot(slot, false);
+            return;
+        }
     }
 
     std::vector<std::thread> _threadsVec;
-    std::condition_variable _cv;
+    std::unique_ptr<std::atomic<bool>[]> _slotExited;
+    EventCount _eventCount;
     std::atomic<bool> stopped;
     std::chrono::seconds _keepAliveTime;
     size_t _minThreads;
     size_t _maxThreads;
-    size_t _tasksPerThreadThreshold;
     
     std::atomic<size_t> _activeThreads;
+    std::atomic<size_t> _idleWorkers{0};
+    std::atomic<size_t> _retireRequests{0};
+    std::atomic<size_t> _idleRetirements{0};
+
+    //scaling controller, state below guarded by _scalingMutex
+    static constexpr size_t kWaitSampleEvery = 16;
+    struct ScalingState {
+        size_t waitSum{0};
+        size_t waitSamples{0};
+        double utilization{0.0};
+        size_t checks{0};
+        size_t quietChecks{0};
+        std::chrono::steady_clock::time_point lastChange{};
+        size_t scaleUps{0};
+        size_t scaleDowns{0};
+        std::deque<ScalingDecision> history;
+    };
+    std::mutex _scalingMutex;
+    ScalingState _scaling;
+
+    //controller thread, only running when the pool can change size
+    std::mutex _controllerMutex;
+    std::condition_variable _controllerCv;
+    std::thread _controllerThread;
+    bool _controllerWake{false};
+    bool _controllerStopped{false};
+
+    //A worker out of the pool, parked on its own condition variable until activated
+    struct Standby {
+        std::condition_variable cv;
+        bool activated{false};
+    };
+    std::unique_ptr<Standby[]> _standby; //per slot, guarded by _mutex
+    std::vector<size_t> _standbySlots;   //parked slots, guarded by _mutex
+    size_t _standbyActivations{0};       //guarded by _mutex
+    size_t _threadsCreated{0};           //guarded by _mutex
+
+    //Counts idle workers for the utilization estimate
+    struct IdleScope {
+        std::atomic<size_t>& idle;
+        explicit IdleScope(std::atomic<size_t>& counter) : idle(counter) { idle.fetch_add(1, std::memory_order_relaxed); }
+        ~IdleScope() { idle.fetch_sub(1, std::memory_order_relaxed); }
+    };
     
-    //work stealing
-    std::vector<std::unique_ptr<MPMCQueue<Task>>> _localQVec;
+    //work stealing, a deque per priority level for each slot, owned by the worker in it
+    using LocalQueues = std::array<std::unique_ptr<WorkStealingDeque<Task>>, static_cast<size_t>(Priority::kNumPriorities)>;
+    std::vector<LocalQueues> _localQVec;
+    thread_local static inline Executor* currentExecutor = nullptr;
     thread_local static inline size_t currentThreadId = std::numeric_limits<size_t>::max();
+    thread_local static inline uint64_t stealRandState = 0x9E3779B97F4A7C15ull;
+    thread_local static inline int64_t lifoGraceEnd = 0; //set by stealLifoTask()
+    thread_local static inline std::array<int64_t, static_cast<size_t>(Priority::kNumPriorities)> priorityCredits{};
+    thread_local static inline Deadline runningDeadline = Deadline::max();
+    thread_local static inline size_t enqueueSampleTick = 0;
+    thread_local static inline Priority runningPriority = Priority::Normal;
+    thread_local static inline std::chrono::steady_clock::time_point sliceStart{};
+
+    //Written only by the owning worker, read by stealStats() / idleStats()
+    struct alignas(64) WorkerCounters {
+        std::atomic<size_t> attempts{0};
+        std::atomic<size_t> successes{0};
+        std::atomic<size_t> tasksStolen{0};
+        std::atomic<size_t> spinNanos{0};
+        std::atomic<size_t> yieldNanos{0};
+        std::atomic<size_t> parkedNanos{0};
+        std::atomic<size_t> parks{0};
+        std::atomic<size_t> deadlinesMet{0};
+        std::atomic<size_t> deadlinesMissed{0};
+        std::array<std::atomic<size_t>, kLatenessBuckets> missLateness{};
+        std::atomic<size_t> queueWaitUs{0};
+        std::atomic<size_t> queueWaitSamples{0};
+        std::atomic<size_t> yields{0};
+
+        static void add(std::atomic<size_t>& counter, size_t n) {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        //Adds the time since `since` and returns now, so phases can be chained
+        static std::chrono::steady_clock::time_point addIdle(std::atomic<size_t>& counter,
+                                                             std::chrono::steady_clock::time_point since) {
+            auto now = std::chrono::steady_clock::now();
+            add(counter, std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count());
+            return now;
+        }
+    };
+    std::unique_ptr<WorkerCounters[]> _workerCounters;
+    size_t _workerSlots{0};
+
+#if EXECUTOR_LATENCY_HISTOGRAMS
+    //Written only by the owning worker, merged by latencyStats()
+    struct WorkerLatency {
+        std::array<LatencyHistogram, static_cast<size_t>(Priority::kNumPriorities)> wait;
+        std::array<LatencyHistogram, static_cast<size_t>(Priority::kNumPriorities)> run;
+    };
+    std::unique_ptr<WorkerLatency[]> _workerLatency;
+#endif
+
+    //timers, everything guarded by _timerMutex
+    TimerWheel<Task> _timers;
+    std::mutex _timerMutex;
+    std::condition_variable _timerCv;
+    std::thread _timerThread;
+    Deadline _timerWakeAt{Deadline::max()};
+    bool _timersStopped{false};
+
+    //blocking calls, kept off the CPU workers
+    BlockingPool<Func> _blockingPool;
+
+    //placement, empty when unpinned
+    std::vector<int> _slotCpu;
+    std::vector<size_t> _slotNode;
+    size_t _numaNodes{1};
+
+    bool sameNode(size_t a, size_t b) const {
+        return _slotNode.empty() || _slotNode[a] == _slotNode[b];
+    }
 
   protected:
+    bool isWorkerThread() const {
+        return currentExecutor == this && currentThreadId < _localQVec.size();
+    }
+
+    //The calling worker's deque for level p, only with stealing enabled on a worker
+    WorkStealingDeque<Task>& localQueue(size_t p) const {
+        return *_localQVec[currentThreadId][p];
+    }
+
     std::atomic<size_t> _pendingTasks;
     std::array<std::unique_ptr<MPMCQueue<Task>>, static_cast<size_t>(Priority::kNumPriorities)> _taskQArray;
+    DeadlineQueue<Task> _deadlineQ;
+    ResumeQueue _resumeQ;
     std::mutex _mutex;
     size_t _taskPoolSize;
     Config _config;
 
+    //admission control, only touched when some level has a capacity
+    bool _bounded;
+    std::array<std::unique_ptr<BoundedMPMCQueue<Task>>, static_cast<size_t>(Priority::kNumPriorities)> _boundedQArray;
+    struct alignas(64) LevelAdmission {
+        std::atomic<size_t> inFlight{0}; //admitted and not yet dequeued
+        std::atomic<size_t> queued{0};
+        std::atomic<size_t> blocked{0};
+        std::atomic<size_t> rejected{0};
+        std::atomic<size_t> ranInline{0};
+        std::atomic<size_t> shed{0};
+        EventCount space; //producers blocked on a full level
+    };
+    std::array<LevelAdmission, static_cast<size_t>(Priority::kNumPriorities)> _levels;
+
+    //per worker slot. The owner fills and empties it, idle workers may take the
+    //task too, so task is guarded by locked. full lets them skip empty slots,
+    //fills tells them whether it still holds the task they saw last time.
+    struct alignas(64) LifoSlot {
+        std::atomic<bool> locked{false};
+        std::atomic<bool> full{false};
+        std::atomic<uint64_t> fills{0}; //tasks put there so far, owner writes
+        std::optional<Task> task;
+        size_t runs{0}; //slot tasks run in a row, owner only
+
+        void lock() {
+            while (locked.exchange(true, std::memory_order_acquire)) cpuRelax();
+        }
+        bool tryLock() { return !locked.exchange(true, std::memory_order_acquire); }
+        void unlock() { locked.store(false, std::memory_order_release); }
+    };
+    std::unique_ptr<LifoSlot[]> _lifoSlots;
+
+    //What a worker last saw in another's slot and when, [thief * slots + victim].
+    //The thieves keep the time, the owner's fill is just a counter bump.
+    struct LifoSighting {
+        uint64_t fills{0};
+        int64_t seenAt{0};
+    };
+    std::unique_ptr<LifoSighting[]> _lifoSightings;
+
+    //How long a slot task is left to its owner before others may take it (Go's runnext)
+    static constexpr int64_t kLifoStealGraceNs = 10'000;
+    static constexpr std::chrono::milliseconds kLifoRecheck{1};
+
+    //Idle workers still spinning or yielding, they will look at the slots again
+    std::atomic<size_t> _searchingWorkers{0};
+
     virtual void run () {
         while (true) {
             Task task([] {});
             if (!waitForTask(task)) {
                 return;
             }
+            recordQueueWait(task);
             executeTask(task);
         }
     }
 
+    // Every kWaitSampleEvery-th task per submitting thread carries its enqueue time,
+    // every task does when latency histograms are compiled in
+    static void sampleEnqueue(Task& task) {
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        task.enqueuedNs = nowNanos();
+#endif
+        if ((++enqueueSampleTick & (kWaitSampleEvery - 1)) != 0) return;
+        task.enqueuedUs = nowMicros() | 1;
+    }
+
+    // The running task's priority, deadline and slice start, put back once a
+    // task run from inside it returns
+    struct NestedRun {
+        Priority priority = runningPriority;
+        Deadline deadline = runningDeadline;
+        std::chrono::steady_clock::time_point slice = sliceStart;
+        ~NestedRun() {
+            runningPriority = priority;
+            runningDeadline = deadline;
+            sliceStart = slice;
+        }
+    };
+
+    void executeTask(Task& task) {
+        runningPriority = task.priority;
+        if (_config.timeSlice.count() > 0) sliceStart = std::chrono::steady_clock::now();
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        int64_t dequeuedNs = nowNanos();
+#endif
+        try {
+             task(); //run the task
+        } catch (const std::exception& e) { handleTaskError(e); } 
+        catch (...) { handleUnknownError(); }
+#if EXECUTOR_LATENCY_HISTOGRAMS
+        recordLatency(task, dequeuedNs, nowNanos());
+#endif
+
+        if (runningDeadline != Deadline::max()) {
+            recordDeadline(runningDeadline);
+            runningDeadline = Deadline::max();
+        }
+    }
+
+#if EXECUTOR_LATENCY_HISTOGRAMS
+    void recordLatency(const Task& task, int64_t dequeuedNs, int64_t completedNs) {
+        auto& latency = _workerLatency[currentThreadId];
+        auto p = static_cast<size_t>(task.priority);
+        if (task.enqueuedNs != 0) latency.wait[p].record(static_cast<uint64_t>(std::max<int64_t>(dequeuedNs - task.enqueuedNs, 0)));
+        latency.run[p].record(static_cast<uint64_t>(completedNs - dequeuedNs));
+    }
+#endif
+
+    static int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void recordQueueWait(const Task& task) {
+        if (task.enqueuedUs == 0) return;
+        auto& counters = _workerCounters[currentThreadId];
+        WorkerCounters::add(counters.queueWaitUs, static_cast<uint32_t>(nowMicros() - task.enqueuedUs));
+        WorkerCounters::add(counters.queueWaitSamples, 1);
+    }
+
+    //Wake up to count parked workers, count == max wakes them all
+    virtual void wakeWorkers(size_t count) {
+        //A single atomic load when none is parked
+        if (count == 1) _eventCount.notifyOne();
+        else _eventCount.notifyMany(count);
+    }
+
+    // Queues [first, last) past admission: counted, sampled, published in bulk
+    template<typename It>
+    void enqueueBatch(It first, It last) {
+        size_t count = 0;
+        for (auto it = first; it != last; ++it, ++count) sampleEnqueue(*it);
+        if (count == 0) return;
+        _pendingTasks.fetch_add(count, std::memory_order_relaxed);
+
+        bool local = _config.enableWorkStealing && isWorkerThread();
+        while (first != last) {
+            auto priority = first->priority;
+            auto runEnd = std::find_if(std::next(first), last,
+                [priority](const Task& task) { return task.priority != priority; });
+            if (local) localQueue(static_cast<size_t>(priority)).pushBulk(first, runEnd);
+            else pushGlobalBulk(static_cast<size_t>(priority), first, runEnd);
+            first = runEnd;
+        }
+
+        onTaskQueued(count);
+    }
+
+    // A bounded level's ring only overflows into its linked queue for tasks
+    // admitted past capacity (yields, timers), so it never spins on a full ring
+    void pushGlobal(Task&& task) {
+        size_t p = static_cast<size_t>(task.priority);
+        if (_boundedQArray[p] && _boundedQArray[p]->try_push(std::move(task))) return;
+        _taskQArray[p]->push(std::move(task));
+    }
+
+    template<typename It>
+    void pushGlobalBulk(size_t p, It first, It last) {
+        if (_boundedQArray[p]) {
+            for (; first != last && _boundedQArray[p]->try_push(std::move(*first)); ++first) {}
+        }
+        _taskQArray[p]->pushBulk(first, last);
+    }
+
+    bool popGlobal(size_t p, Task& task) {
+        if (_boundedQArray[p] && _boundedQArray[p]->try_pop(task)) return true;
+        return _taskQArray[p]->try_pop(task);
+    }
+
+    bool globalEmpty(size_t p) const {
+        return (!_boundedQArray[p] || _boundedQArray[p]->empty()) && _taskQArray[p]->empty();
+    }
+
+    // Every dequeue of a task that went through admission
+    void taskDequeued(const Task& task) {
+        _pendingTasks--;
+        releaseSlot(task.priority);
+    }
+
+    void releaseSlot(Priority priority) {
+        size_t p = static_cast<size_t>(priority);
+        if (_config.queueCapacity[p] == 0) return;
+        _levels[p].inFlight.fetch_sub(1, std::memory_order_relaxed);
+        _levels[p].space.notifyOne(); //a single load unless a producer is blocked
+    }
+
+    // Up to count slots at level p, all of them on an unbounded level
+    size_t reserveSlots(size_t p, size_t count) {
+        size_t capacity = _config.queueCapacity[p];
+        if (capacity == 0) return count;
+
+        auto& level = _levels[p];
+        size_t inFlight = level.inFlight.load(std::memory_order_relaxed);
+        while (true) {
+            size_t granted = inFlight >= capacity ? 0 : std::min(count, capacity - inFlight);
+            if (granted == 0) return 0;
+            if (level.inFlight.compare_exchange_weak(inFlight, inFlight + granted, std::memory_order_relaxed)) {
+                level.queued.fetch_add(granted, std::memory_order_relaxed);
+                return granted;
+            }
+        }
+    }
+
+    // Work already accepted elsewhere, may overshoot the capacity
+    void forceAdmit(Priority priority) {
+        size_t p = static_cast<size_t>(priority);
+        if (_config.queueCapacity[p] == 0) return;
+        _levels[p].inFlight.fetch_add(1, std::memory_order_relaxed);
+        _levels[p].queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool levelFull(size_t p) const {
+        size_t capacity = _config.queueCapacity[p];
+        return capacity > 0 && _levels[p].inFlight.load(std::memory_order_relaxed) >= capacity;
+    }
+
+    // Queued: a slot is reserved and the caller enqueues the task. Anything else
+    // means the overflow policy already dealt with it.
+    Admission admit(Task& task) {
+        size_t p = static_cast<size_t>(task.priority);
+        auto& level = _levels[p];
+        auto policy = _config.overflowPolicy;
+
+        //Overloaded anywhere: Low work goes first
+        if (policy == OverflowPolicy::ShedLow && task.priority == Priority::Low) {
+            bool overloaded = false;
+            for (size_t q = 0; q < p; ++q) overloaded = overloaded || levelFull(q);
+            if (overloaded || !reserveSlots(p, 1)) {
+                level.shed.fetch_add(1, std::memory_order_relaxed);
+                return Admission::Shed;
+            }
+            return Admission::Queued;
+        }
+        if (reserveSlots(p, 1)) return Admission::Queued;
+
+        if (policy == OverflowPolicy::Block || policy == OverflowPolicy::ShedLow) {
+            //A worker waiting on its own pool could leave nobody to make room
+            if (currentExecutor == this) policy = OverflowPolicy::RunInline;
+            else return waitForSlot(p);
+        }
+
+        if (policy == OverflowPolicy::RunInline) {
+            level.ranInline.fetch_add(1, std::memory_order_relaxed);
+            runInline(task);
+            return Admission::RanInline;
+        }
+
+        level.rejected.fetch_add(1, std::memory_order_relaxed);
+        return Admission::Rejected;
+    }
+
+    Admission waitForSlot(size_t p) {
+        auto& level = _levels[p];
+        level.blocked.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            auto key = level.space.prepareWait();
+            if (reserveSlots(p, 1)) {
+                level.space.cancelWait();
+                return Admission::Queued;
+            }
+            if (stopped) {
+                level.space.cancelWait();
+                level.rejected.fetch_add(1, std::memory_order_relaxed);
+                return Admission::Rejected;
+            }
+            level.space.waitUntil(key, Deadline::max());
+        }
+    }
+
+    // On the caller's stack, without touching the worker's running task state
+    void runInline(Task& task) {
+        try {
+            task();
+        } catch (const std::exception& e) { handleTaskError(e); }
+        catch (...) { handleUnknownError(); }
+    }
+
+    //Slot of the calling worker thread, only meaningful on a worker
+    static size_t currentWorkerSlot() { return currentThreadId; }
+
+    // Own deques and global queues together, so a task keeps its priority wherever it
+    // was submitted from. Within the picked level our own deque goes first.
+    bool popQueuedTask(Task& task) {
+        bool withLocal = _config.enableWorkStealing && isWorkerThread();
+        for (size_t attempt = 0; attempt < static_cast<size_t>(Priority::kNumPriorities); ++attempt) {
+            size_t p = nextPriorityLevel(withLocal);
+            if (p == static_cast<size_t>(Priority::kNumPriorities)) break;
+            if ((withLocal && localQueue(p).pop(task)) || popGlobal(p, task)) {
+                taskDequeued(task);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Global priority queues, weighted across priority levels
+    bool popGlobalTask(Task& task) {
+        for (size_t attempt = 0; attempt < static_cast<size_t>(Priority::kNumPriorities); ++attempt) {
+            size_t p = nextPriorityLevel();
+            if (p == static_cast<size_t>(Priority::kNumPriorities)) break;
+            if(popGlobal(p, task)) {
+                taskDequeued(task);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Smooth weighted round robin over the non-empty global queues: every
+    // backlogged level earns its weight in credit per pick, the richest level
+    // is served and pays back the total. Ties go to the higher priority.
+    // withLocal counts the calling worker's own deques as part of their level.
+    // Returns kNumPriorities when all those queues look empty.
+    size_t nextPriorityLevel(bool withLocal = false) {
+        constexpr size_t kLevels = static_cast<size_t>(Priority::kNumPriorities);
+        int64_t totalWeight = 0;
+        size_t best = kLevels;
+
+        for (size_t p = 0; p < kLevels; ++p) {
+            if (globalEmpty(p) && (!withLocal || localQueue(p).empty())) {
+                priorityCredits[p] = 0; //no banking credit while idle
+                continue;
+            }
+            auto weight = static_cast<int64_t>(_config.priorityWeights[p]);
+            priorityCredits[p] += weight;
+            totalWeight += weight;
+            if (best == kLevels || priorityCredits[p] > priorityCredits[best]) best = p;
+        }
+
+        if (best != kLevels) priorityCredits[best] -= totalWeight;
+        return best;
+    }
+
+    bool onOwnWorker() const {
+        return currentExecutor == this && currentThreadId < _workerSlots;
+    }
+
+    // Puts task in the calling worker's LIFO slot. True when that displaced an
+    // older task, which is handed back in task for the caller to queue.
+    bool swapLifo(Task& task) {
+        auto& slot = _lifoSlots[currentThreadId];
+        slot.lock();
+        bool displaced = slot.task.has_value();
+        if (displaced) {
+            std::swap(*slot.task, task);
+        } else {
+            slot.task.emplace(std::move(task));
+            slot.full.store(true, std::memory_order_release);
+        }
+        slot.fills.store(slot.fills.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        slot.unlock();
+        return displaced;
+    }
+
+    // The calling worker's slot task. withinBudget turns it down once the slot has
+    // run lifoSlotBudget times in a row, the next call gets it again. Accounting
+    // is left to the caller, the slot holds whatever its queue would have.
+    bool popLifoTask(Task& task, bool withinBudget) {
+        if (!onOwnWorker() || !_lifoSlots) return false;
+        auto& slot = _lifoSlots[currentThreadId];
+        if (!slot.full.load(std::memory_order_acquire)) {
+            slot.runs = 0; //chain broken
+            return false;
+        }
+        if (withinBudget && slot.runs >= _config.lifoSlotBudget) {
+            slot.runs = 0;
+            return false;
+        }
+
+        slot.lock();
+        bool taken = slot.task.has_value();
+        //Nor does it jump ahead of queued work of a higher level
+        if (taken && withinBudget && higherLevelQueued(slot.task->priority)) {
+            slot.unlock();
+            return false;
+        }
+        if (taken) {
+            task = std::move(*slot.task);
+            slot.task.reset();
+            slot.full.store(false, std::memory_order_relaxed);
+        }
+        slot.unlock();
+
+        if (taken) ++slot.runs;
+        else slot.runs = 0; //an idle worker took it
+        return taken;
+    }
+
+    // Another worker's slot task, seen there for kLifoStealGraceNs while its owner
+    // stayed busy. Needs no deques, without stealing the task would have gone to
+    // the global queue anyway. A slot still in its grace period is noted in
+    // lifoGraceEnd, so a worker about to park comes back for it.
+    bool stealLifoTask(Task& task) {
+        lifoGraceEnd = 0;
+        if (!onOwnWorker() || !_lifoSlots) return false;
+        size_t startIdx = nextStealRandom() % _workerSlots;
+        LifoSighting* sightings = &_lifoSightings[currentThreadId * _workerSlots];
+        int64_t now = 0;
+        for (size_t i = 0; i < _workerSlots; ++i) {
+            size_t victimId = (startIdx + i) % _workerSlots;
+            auto& slot = _lifoSlots[victimId];
+            if (victimId == currentThreadId || !slot.full.load(std::memory_order_relaxed)) continue;
+
+            if (now == 0) now = nowNanos();
+            uint64_t fills = slot.fills.load(std::memory_order_relaxed);
+            auto& seen = sightings[victimId];
+            if (seen.fills != fills) seen = {fills, now}; //a task we haven't seen yet
+            int64_t graceEnd = seen.seenAt + kLifoStealGraceNs;
+            if (now < graceEnd) {
+                if (lifoGraceEnd == 0 || graceEnd < lifoGraceEnd) lifoGraceEnd = graceEnd;
+                continue; //the owner may well be about to run it
+            }
+            if (!slot.tryLock()) continue; //its owner is at it
+            if (slot.fills.load(std::memory_order_relaxed) != fills) {
+                slot.unlock(); //replaced meanwhile, the owner is moving
+                continue;
+            }
+
+            bool taken = slot.task.has_value();
+            if (taken) {
+                task = std::move(*slot.task);
+                slot.task.reset();
+                slot.full.store(false, std::memory_order_relaxed);
+            }
+            slot.unlock();
+            if (!taken) continue;
+
+            auto& counters = _workerCounters[currentThreadId];
+            WorkerCounters::add(counters.successes, 1);
+            WorkerCounters::add(counters.tasksStolen, 1);
+            taskDequeued(task);
+            return true;
+        }
+        return false;
+    }
+
+    bool higherLevelQueued(Priority priority) const {
+        bool withLocal = _config.enableWorkStealing && isWorkerThread();
+        for (size_t p = 0; p < static_cast<size_t>(priority); ++p) {
+            if (!globalEmpty(p) || (withLocal && !localQueue(p).empty())) return true;
+        }
+        return false;
+    }
+
+    // The resume runs as an ordinary task, its lambda fits Task's inline buffer.
+    // Our own resume shard first, then the others.
+    bool popResumeTask(Task& task) {
+        std::coroutine_handle<> handle;
+        if (!_resumeQ.try_pop(handle, onOwnWorker() ? currentThreadId : 0)) return false;
+        _pendingTasks--;
+        task = Task([handle] () { handle.resume(); });
+        return true;
+    }
+
+    // Earliest deadline first, executeTask() records whether it was met
+    bool popDeadlineTask(Task& task) {
+        Deadline deadline;
+        if (!_deadlineQ.try_pop(task, deadline)) return false;
+        runningDeadline = deadline;
+        _pendingTasks--;
+        return true;
+    }
+
     bool tryStealTask(Task& task) {
-        if (!_config.enableWorkStealing) return false;
+        if (!_config.enableWorkStealing || !isWorkerThread()) return false;
        
-        // Try stealing from other threads' local queues
-        size_t startIdx = (currentThreadId + 1) % _localQVec.size();
-        for (size_t i = 0; i < _localQVec.size(); ++i) {
-            size_t victimId = (startIdx + i) % _localQVec.size();
-            if (_localQVec[victimId]->try_pop(task)) {
-                _pendingTasks--;
-                return true;
+        // Try stealing from other threads' local queues, starting at a random
+        // victim so idle workers don't all converge on the same neighbour.
+        // Levels go highest first, any victim's High task before anyone's Low one.
+        // With pinned placement the first pass of each level stays on our NUMA node.
+        const size_t numQ = _localQVec.size();
+        size_t startIdx = nextStealRandom() % numQ;
+        auto& counters = _workerCounters[currentThreadId];
+
+        for (size_t p = 0; p < static_cast<size_t>(Priority::kNumPriorities); ++p) {
+            for (size_t pass = 0; pass < (_numaNodes > 1 ? 2 : 1); ++pass) {
+                for (size_t i = 0; i < numQ; ++i) {
+                    size_t victimId = (startIdx + i) % numQ;
+                    auto& victim = *_localQVec[victimId][p];
+
+                    if (victimId == currentThreadId || victim.empty()) continue;
+                    if (sameNode(victimId, currentThreadId) != (pass == 0)) continue;
+                    WorkerCounters::add(counters.attempts, 1);
+                    //Steal half: one claim on the victim's top, the rest of the batch
+                    //lands on our deque of the same level and stays pending there
+                    size_t stolen = _config.enableStealHalf
+                        ? victim.stealBatch(task, localQueue(p), WorkStealingDeque<Task>::kMaxBatch)
+                        : (victim.steal(task) ? 1 : 0);
+                    if (stolen == 0) continue;
+
+                    WorkerCounters::add(counters.successes, 1);
+                    WorkerCounters::add(counters.tasksStolen, stolen);
+                    taskDequeued(task);
+                    return true;
+                }
             }
         }
         return false;
     }
+
+    static uint64_t nextStealRandom() {
+        //xorshift64
+        stealRandState ^= stealRandState << 13;
+        stealRandState ^= stealRandState >> 7;
+        stealRandState ^= stealRandState << 17;
+        return stealRandState;
+    }
     
 };
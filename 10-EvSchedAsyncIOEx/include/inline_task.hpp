@@ -0,0 +1,111 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//Move-only void() callable with a small inline buffer, replaces std::function for tasks.
+//Callables up to Capacity bytes that are nothrow movable live inside the object,
+//bigger ones are boxed on the heap. Targets never need to be copyable, so lambdas
+//can capture unique_ptr / promise / futures directly.
+template <size_t Capacity>
+class InlineTask {
+    static_assert(Capacity >= sizeof(void*), "inline capacity must at least hold a pointer");
+
+public:
+    static constexpr size_t kCapacity = Capacity;
+
+    template <typename F>
+    static constexpr bool fitsInline() {
+        return sizeof(F) <= Capacity &&
+               alignof(F) <= alignof(void*) &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+    InlineTask() noexcept = default;
+    InlineTask(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, InlineTask> && std::is_invocable_r_v<void, Fn&>>>
+    InlineTask(F&& f) {
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void*>(_storage)) Fn(std::forward<F>(f));
+            _ops = &kInlineOps<Fn>;
+        } else {
+            ::new (static_cast<void*>(_storage)) Fn*(new Fn(std::forward<F>(f)));
+            _ops = &kHeapOps<Fn>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept { moveFrom(other); }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() { reset(); }
+
+    //Requires a target: calling an empty or moved-from task is undefined
+    void operator()() {
+        assert(_ops && "InlineTask called without a target");
+        _ops->invoke(_storage);
+    }
+
+    explicit operator bool() const noexcept { return _ops != nullptr; }
+
+    //True if the target was boxed on the heap
+    bool onHeap() const noexcept { return _ops && _ops->heap; }
+
+    void reset() noexcept {
+        if (_ops) {
+            _ops->destroy(_storage);
+            _ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src) noexcept; //move constructs dst, destroys src
+        void (*destroy)(void*) noexcept;
+        bool heap;
+    };
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps{
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+        false
+    };
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps{
+        [](void* p) { (**static_cast<Fn**>(p))(); },
+        [](void* dst, void* src) noexcept { ::new (dst) Fn*(*static_cast<Fn**>(src)); },
+        [](void* p) noexcept { delete *static_cast<Fn**>(p); },
+        true
+    };
+
+    void moveFrom(InlineTask& other) noexcept {
+        if (!other._ops) return;
+        other._ops->move(_storage, other._storage);
+        _ops = other._ops;
+        other._ops = nullptr;
+    }
+
+    alignas(void*) unsigned char _storage[Capacity];
+    const Ops* _ops{nullptr};
+};
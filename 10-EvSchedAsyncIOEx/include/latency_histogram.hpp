@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+//Bucket layout shared by LatencyHistogram and LatencySummary
+inline constexpr size_t kLatencySubBucketBits = 4;
+inline constexpr size_t kLatencyMaxExponent = 36;
+inline constexpr size_t kLatencyBuckets = (kLatencyMaxExponent - kLatencySubBucketBits + 1) * (size_t{1} << kLatencySubBucketBits);
+
+//Smallest value that lands in bucket
+constexpr uint64_t latencyBucketLow(size_t bucket) {
+    constexpr size_t subBuckets = size_t{1} << kLatencySubBucketBits;
+    if (bucket < subBuckets) return bucket;
+    size_t exponent = bucket / subBuckets + kLatencySubBucketBits - 1;
+    uint64_t sub = bucket % subBuckets;
+    return (subBuckets + sub) << (exponent - kLatencySubBucketBits);
+}
+
+//Plain merged view of one or more histograms
+struct LatencySummary {
+    std::array<uint64_t, kLatencyBuckets> counts{};
+    uint64_t count{0};
+    uint64_t sum{0};
+    uint64_t max{0};
+
+    uint64_t mean() const { return count ? sum / count : 0; }
+
+    //Upper edge of the bucket holding the q-th quantile, q in [0, 1]
+    uint64_t percentile(double q) const {
+        if (count == 0) return 0;
+        auto rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < counts.size(); ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                return b + 1 < counts.size() ? std::min(max, latencyBucketLow(b + 1) - 1) : max;
+            }
+        }
+        return max;
+    }
+};
+
+//Log-linear latency histogram in the HDR style: values below 2^kSubBucketBits ns get
+//a bucket each, every power of two above is split into 2^kSubBucketBits buckets, so
+//any value is off by at most 1 / 2^kSubBucketBits (~6%). Values are clamped at 2^36 ns
+//(~69s). Recording is single writer and lock free, readers fold it into a
+//LatencySummary with mergeInto().
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBucketBits = kLatencySubBucketBits;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kMaxExponent = kLatencyMaxExponent;
+    static constexpr size_t kBuckets = kLatencyBuckets;
+
+    static size_t bucketOf(uint64_t ns) {
+        ns = std::min<uint64_t>(ns, (uint64_t{1} << kMaxExponent) - 1);
+        if (ns < kSubBuckets) return static_cast<size_t>(ns);
+        size_t exponent = std::bit_width(ns) - 1;
+        size_t sub = static_cast<size_t>(ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+        return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+    }
+
+    //Owning thread only
+    void record(uint64_t ns) {
+        add(_counts[bucketOf(ns)], 1);
+        add(_count, 1);
+        add(_sum, ns);
+        if (ns > _max.load(std::memory_order_relaxed)) _max.store(ns, std::memory_order_relaxed);
+    }
+
+    //Any thread, a snapshot racing the writer may be off by the samples in flight
+    void mergeInto(LatencySummary& summary) const {
+        for (size_t b = 0; b < kBuckets; ++b) summary.counts[b] += _counts[b].load(std::memory_order_relaxed);
+        summary.count += _count.load(std::memory_order_relaxed);
+        summary.sum += _sum.load(std::memory_order_relaxed);
+        summary.max = std::max(summary.max, _max.load(std::memory_order_relaxed));
+    }
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> _counts{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+};
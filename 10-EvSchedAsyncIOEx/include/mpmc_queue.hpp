@@ -1,12 +1,20 @@
 #pragma once
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <iterator>
 #include <mutex>
+#include <optional>
 
 //Lock free MPMC queue for memory optimization
 template <typename T>
 class MPMCQueue {
 private:
+    //Pool grows in chunks of doubling size that are never moved once published,
+    //so producers can index nodes without holding _mutex
+    static constexpr size_t kMaxChunks = 48;
+    size_t _chunkBase;
     size_t _poolSize;
 
     struct Node {
@@ -21,55 +29,55 @@ private:
     std::mutex _mutex;
 
     //Dynamic task node pool for MPMC queue mgmt 
-    std::vector<std::unique_ptr<Node>> node_pool;
+    std::array<std::atomic<Node*>, kMaxChunks> _chunks{};
     std::atomic<size_t> pool_idx{0};
 
-    Node* allocateNode() {
-        auto idx = pool_idx.fetch_add(1);
+    //Chunk k holds _chunkBase << k nodes and starts at _chunkBase * (2^k - 1)
+    size_t chunkOf(size_t idx) const {
+        return std::bit_width(idx / _chunkBase + 1) - 1;
+    }
 
-        if (idx >= size(node_pool)) {  //pool exhausted, resize
-            std::lock_guard<std::mutex> lock(_mutex);
-            size_t newSize = node_pool.size() << 1; //double it
-            resizePool(newSize);
-        }
-        
-        auto node = node_pool[idx % node_pool.size()].get();
-        node->next.store(nullptr);
-        node->data.reset();
-        return node;
+    size_t chunkStart(size_t chunk) const {
+        return _chunkBase * ((size_t{1} << chunk) - 1);
     }
 
-public:
-     explicit MPMCQueue(size_t initPoolSize = 1024) : _poolSize(initPoolSize) {
-        node_pool.reserve(_poolSize);
-        for (size_t i = 0; i < _poolSize; ++i) {
-            node_pool.emplace_back(std::make_unique<Node>());
-        } 
+    Node* allocateChunk(size_t chunk) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto nodes = _chunks[chunk].load(std::memory_order_acquire);
+        if (nodes) return nodes; //another producer beat us to it
 
-        auto dummy = allocateNode();
-        head.store(dummy);
-        tail.store(dummy);
+        nodes = new Node[_chunkBase << chunk];
+        _chunks[chunk].store(nodes, std::memory_order_release);
+        _poolSize += _chunkBase << chunk;
+        return nodes;
     }
 
-    bool empty() const {
-        auto h = head.load(std::memory_order_acquire);
-        auto n = h->next.load(std::memory_order_acquire);
-        return n == nullptr;
+    Node* allocateNode() {
+        return nodeAt(pool_idx.fetch_add(1, std::memory_order_relaxed));
     }
 
-    void push(T value) {
-        auto node = allocateNode();
-        node->data.emplace(std::move(value));
+    Node* nodeAt(size_t idx) {
+        auto chunk = chunkOf(idx);
+
+        auto nodes = _chunks[chunk].load(std::memory_order_acquire);
+        if (!nodes) nodes = allocateChunk(chunk); //pool exhausted, grow
 
+        auto node = &nodes[idx - chunkStart(chunk)];
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->data.reset();
+        return node;
+    }
+
+    void linkChain(Node* first, Node* last) {
         while(true) {
             auto old_tail = tail.load(std::memory_order_acquire);
             auto next = old_tail->next.load(std::memory_order_acquire);
 
             if (old_tail == tail.load(std::memory_order_acquire)) {
                 if (next == nullptr) {
-                    if (old_tail->next.compare_exchange_weak(next, node,
+                    if (old_tail->next.compare_exchange_weak(next, first,
                         std::memory_order_release, std::memory_order_acquire)) {
-                        tail.compare_exchange_strong(old_tail, node,
+                        tail.compare_exchange_strong(old_tail, last,
                             std::memory_order_release, std::memory_order_relaxed);
                         return;
                     }
@@ -81,6 +89,48 @@ public:
         }
     }
 
+public:
+     explicit MPMCQueue(size_t initPoolSize = 1024)
+       : _chunkBase(std::bit_ceil(std::max(initPoolSize, size_t{1}))), _poolSize(0) {
+        allocateChunk(0);
+
+        auto dummy = allocateNode();
+        head.store(dummy);
+        tail.store(dummy);
+    }
+
+    bool empty() const {
+        auto h = head.load(std::memory_order_acquire);
+        auto n = h->next.load(std::memory_order_acquire);
+        return n == nullptr;
+    }
+
+    void push(T value) {
+        auto node = allocateNode();
+        node->data.emplace(std::move(value));
+        linkChain(node, node);
+    }
+
+    //Moves [first, last) in as one chain: nodes are reserved with one fetch_add and
+    //linked privately, then published with a single CAS on the tail
+    template <typename It>
+    void pushBulk(It first, It last) {
+        auto count = static_cast<size_t>(std::distance(first, last));
+        if (count == 0) return;
+
+        auto idx = pool_idx.fetch_add(count, std::memory_order_relaxed);
+        Node* chainHead = nodeAt(idx);
+        chainHead->data.emplace(std::move(*first));
+        Node* chainTail = chainHead;
+        for (++first; first != last; ++first) {
+            Node* node = nodeAt(++idx);
+            node->data.emplace(std::move(*first));
+            chainTail->next.store(node, std::memory_order_relaxed);
+            chainTail = node;
+        }
+        linkChain(chainHead, chainTail);
+    }
+
     bool try_pop(T& value) {
         while (true) {
             auto old_head = head.load(std::memory_order_acquire);
@@ -102,23 +152,24 @@ public:
         }
     }
     
-    // Method to resize pool
+    // Method to resize pool, pre-allocates chunks so later pushes stay off the slow path
     void resizePool(size_t newSize) {
-        if (newSize <= _poolSize) return;
-        
-        size_t additionalNodes = newSize - _poolSize;
-        node_pool.reserve(newSize);
-        
-        for (size_t i = 0; i < additionalNodes; ++i) {
-            node_pool.emplace_back(std::make_unique<Node>());
+        for (size_t chunk = 0; chunk < kMaxChunks && chunkStart(chunk) < newSize; ++chunk) {
+            if (!_chunks[chunk].load(std::memory_order_acquire)) allocateChunk(chunk);
         }
-        
-        _poolSize = newSize;
+    }
+
+    size_t poolSize() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _poolSize;
     }
 
     ~MPMCQueue() {
         head.store(nullptr);
         tail.store(nullptr);
+        for (auto& chunk : _chunks) {
+            delete[] chunk.load();
+        }
     }
 
 }; 
@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "executor.hpp"
+#include "task_group.hpp"
+
+//Fork-join loops over an index range on an Executor. The range is cut into chunks
+//of `grain` indices and split in halves recursively: each split schedules its right
+//half and keeps the left, so from a worker the halves land on its own deque and
+//idle workers steal the biggest ones first. The caller runs the leftmost chunk and,
+//when it is a worker of the same executor, keeps running queued tasks until the
+//loop is done instead of blocking its thread.
+//
+//grain 0 picks one: enough chunks for kChunksPerThread per pool thread, so a slow
+//chunk can be balanced out, while a chunk still amortises its task.
+//The first exception thrown by the body is rethrown to the caller once all
+//chunks are finished.
+namespace parallel_detail {
+
+inline constexpr size_t kChunksPerThread = 8;
+
+inline size_t autoGrain(const Executor& executor, size_t count) {
+    size_t chunks = std::max<size_t>(executor.maxThreads(), 1) * kChunksPerThread;
+    return std::max<size_t>(count / chunks, 1);
+}
+
+//Runs chunkFn(c) for every c in [0, chunks)
+template<typename ChunkFn>
+class ForkJoin {
+public:
+    ForkJoin(Executor& executor, ChunkFn& chunkFn) : _executor(executor), _chunkFn(chunkFn), _group(executor) {}
+
+    void run(size_t chunks) {
+        if (chunks == 0) return;
+        split(0, chunks);
+        _group.wait(); //a worker of the executor helps run the chunks meanwhile
+        if (_error) std::rethrow_exception(_error);
+    }
+
+private:
+    void split(size_t first, size_t last) {
+        while (last - first > 1) {
+            size_t mid = first + (last - first) / 2;
+            _group.add(1);
+            auto admission = _executor.schedule([this, mid, last] () {
+                split(mid, last);
+                _group.arrive();
+            });
+            //A full or stopped executor doesn't lose the half, we run it here
+            if (admission == Executor::Admission::Rejected || admission == Executor::Admission::Shed) {
+                split(mid, last);
+                _group.arrive();
+            }
+            last = mid;
+        }
+        runChunk(first);
+    }
+
+    void runChunk(size_t chunk) {
+        try {
+            _chunkFn(chunk);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(_errorMutex);
+            if (!_error) _error = std::current_exception();
+        }
+    }
+
+    Executor& _executor;
+    ChunkFn& _chunkFn;
+    TaskGroup _group;
+    std::mutex _errorMutex;
+    std::exception_ptr _error;
+};
+
+} // namespace parallel_detail
+
+//body(i) for every i in [first, last)
+template<typename Index, typename Body>
+void parallel_for(Executor& executor, Index first, Index last, size_t grain, Body&& body) {
+    static_assert(std::is_integral_v<Index>, "parallel_for works on integer index ranges");
+    if (last <= first) return;
+    if (grain == 0) grain = parallel_detail::autoGrain(executor, static_cast<size_t>(last - first));
+
+    auto count = static_cast<size_t>(last - first);
+    auto chunkFn = [&] (size_t chunk) {
+        size_t end = std::min(chunk * grain + grain, count);
+        for (size_t k = chunk * grain; k < end; ++k) body(static_cast<Index>(first + static_cast<Index>(k)));
+    };
+    parallel_detail::ForkJoin<decltype(chunkFn)>(executor, chunkFn).run((count + grain - 1) / grain);
+}
+
+template<typename Index, typename Body>
+void parallel_for(Executor& executor, Index first, Index last, Body&& body) {
+    parallel_for(executor, first, last, 0, std::forward<Body>(body));
+}
+
+//Folds map(i) over [first, last) with combine, starting every chunk from identity.
+//Chunk results are combined left to right, so combine needs to be associative
+//but not commutative and the result doesn't depend on scheduling.
+template<typename Index, typename T, typename Map, typename Combine>
+T parallel_reduce(Executor& executor, Index first, Index last, size_t grain, T identity, Map&& map, Combine&& combine) {
+    static_assert(std::is_integral_v<Index>, "parallel_reduce works on integer index ranges");
+    if (last <= first) return identity;
+    if (grain == 0) grain = parallel_detail::autoGrain(executor, static_cast<size_t>(last - first));
+
+    auto count = static_cast<size_t>(last - first);
+    size_t chunks = (count + grain - 1) / grain;
+    //One separate object per chunk, vector<bool> would pack them into shared words
+    std::unique_ptr<std::optional<T>[]> partials(new std::optional<T>[chunks]);
+    auto chunkFn = [&] (size_t chunk) {
+        size_t end = std::min(chunk * grain + grain, count);
+        T acc = identity;
+        for (size_t k = chunk * grain; k < end; ++k) acc = combine(std::move(acc), map(static_cast<Index>(first + static_cast<Index>(k))));
+        partials[chunk] = std::move(acc);
+    };
+    parallel_detail::ForkJoin<decltype(chunkFn)>(executor, chunkFn).run(chunks);
+
+    T result = std::move(identity);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) result = combine(std::move(result), std::move(*partials[chunk]));
+    return result;
+}
+
+template<typename Index, typename T, typename Map, typename Combine>
+T parallel_reduce(Executor& executor, Index first, Index last, T identity, Map&& map, Combine&& combine) {
+    return parallel_reduce(executor, first, last, size_t{0}, std::move(identity),
+                           std::forward<Map>(map), std::forward<Combine>(combine));
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include "event_count.hpp"
+
+//Link for queueing a coroutine resumption. It lives in the awaiter, which stays
+//put in the suspended frame until the resume, so queueing allocates nothing.
+//The node is not touched again once its handle has been handed out.
+struct ResumeNode {
+    std::coroutine_handle<> handle;
+    ResumeNode* next{nullptr};
+};
+
+//Intrusive MPMC queue of ResumeNodes, sharded one per worker so workers don't all
+//meet on one cache line. Producers push chains onto a shard's lock free stack with
+//one CAS, a worker pushes to its own shard. Per shard, consumers take turns through
+//a flag: the one holding it moves the stack into a FIFO, so a shard's resumptions
+//come out in the order they went in, and pops the front. A worker pops its own
+//shard first and takes from the others when that is empty.
+class ResumeQueue {
+public:
+    explicit ResumeQueue(size_t shards = 1)
+      : _shardCount(std::max<size_t>(shards, 1)), _shards(new Shard[_shardCount]) {}
+
+    ResumeQueue(const ResumeQueue&) = delete;
+    ResumeQueue& operator=(const ResumeQueue&) = delete;
+
+    size_t shardCount() const { return _shardCount; }
+
+    //count nodes linked through next, starting at first, onto shard % shardCount()
+    void push(ResumeNode& first, size_t count, size_t shard) {
+        _shards[shard % _shardCount].push(first, count);
+    }
+
+    //False only when every shard is empty. A shard another consumer holds is
+    //never taken for empty, we come back to it once the others are done.
+    bool try_pop(std::coroutine_handle<>& handle, size_t home) {
+        for (size_t round = 0; ; ++round) {
+            bool busy = false;
+            for (size_t i = 0; i < _shardCount; ++i) {
+                switch (_shards[(home + i) % _shardCount].tryPop(handle)) {
+                case Pop::Taken: return true;
+                case Pop::Busy: busy = true; break;
+                case Pop::Empty: break;
+                }
+            }
+            if (!busy) return false;
+            //The holder is a few pointer moves from done unless it got preempted
+            if (round < kMaxSpins) cpuRelax();
+            else std::this_thread::yield();
+        }
+    }
+
+    bool empty() const {
+        for (size_t i = 0; i < _shardCount; ++i) {
+            if (_shards[i].size.load(std::memory_order_relaxed) != 0) return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t kMaxSpins = 64;
+
+    enum class Pop { Taken, Empty, Busy };
+
+    struct alignas(64) Shard {
+        std::atomic<ResumeNode*> inbox{nullptr};
+        std::atomic<size_t> size{0};
+        alignas(64) std::atomic<bool> popping{false};
+        ResumeNode* head{nullptr}; //owned by whoever holds popping
+
+        void push(ResumeNode& first, size_t count) {
+            //Store the chain newest first like the stack, takeInbox() turns both around
+            ResumeNode* node = &first;
+            ResumeNode* reversed = nullptr;
+            for (size_t i = 0; i < count; ++i) {
+                ResumeNode* next = node->next;
+                node->next = reversed;
+                reversed = node;
+                node = next;
+            }
+
+            size.fetch_add(count, std::memory_order_relaxed);
+            ResumeNode* top = inbox.load(std::memory_order_relaxed);
+            do {
+                first.next = top;
+            } while (!inbox.compare_exchange_weak(top, reversed, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Pop tryPop(std::coroutine_handle<>& handle) {
+            if (size.load(std::memory_order_relaxed) == 0) return Pop::Empty; //a load on the idle path
+            if (popping.exchange(true, std::memory_order_acquire)) return Pop::Busy;
+
+            if (!head) takeInbox();
+            ResumeNode* node = head;
+            if (node) {
+                head = node->next;
+                handle = node->handle;
+            }
+            popping.store(false, std::memory_order_release);
+            //Counted but not linked yet: the producer is between its add and its CAS
+            if (!node) return Pop::Busy;
+            size.fetch_sub(1, std::memory_order_relaxed);
+            return Pop::Taken;
+        }
+
+        //The stack holds the newest chain first, reversing it gives FIFO order
+        void takeInbox() {
+            ResumeNode* node = inbox.exchange(nullptr, std::memory_order_acquire);
+            ResumeNode* reversed = nullptr;
+            while (node) {
+                ResumeNode* next = node->next;
+                node->next = reversed;
+                reversed = node;
+                node = next;
+            }
+            head = reversed;
+        }
+    };
+
+    size_t _shardCount;
+    std::unique_ptr<Shard[]> _shards;
+};
@@ -0,0 +1,327 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "executor.hpp"
+#include "spsc_ring.hpp"
+
+//Thread-per-core, shared-nothing mode. Each worker owns a shard pinned to one core:
+//a private run queue, its own timer wheel and its inbound rings. Work crosses shards
+//only through an SPSC ring per (sender, receiver) pair, threads outside the pool use
+//the receiver's inbox. Submissions are routed by shard index or key hash and nothing
+//is stolen, so a key's tasks always run on the same core.
+//
+//The Executor-wide paths (scheduleBatch, yieldTask, the Executor timer thread) still
+//arrive through the global queues, every shard polls them between batches of its own
+//work. Deadline tasks are shared too but checked before every local task, earliest
+//deadline first as on Executor. Config::queueCapacity bounds each level across all shards.
+//
+//Each shard's run queue allocates from a pool of its own that only its worker
+//touches, so the memory is first touched on that core. Task captures too big to
+//fit inline and the inbox for outside threads still use the global heap.
+class ShardedExecutor : public Executor {
+public:
+    static constexpr size_t kNoShard = std::numeric_limits<size_t>::max();
+
+    explicit ShardedExecutor(const Config& config = Config{})
+      : Executor(shardConfig(config)) {
+        size_t shardCount = std::max<size_t>(config.threadCount, 1);
+        _shards.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i) {
+            _shards.emplace_back(std::make_unique<Shard>(i, shardCount, config.timerTick));
+        }
+    }
+
+    //Shards park on their own eventcounts, stop while our wakeWorkers() still exists
+    ~ShardedExecutor() override {
+        if (!isStopped()) stop();
+    }
+
+    using Executor::schedule;
+
+    //On a shard the task stays on it, from outside it goes to the shards round robin
+    Admission schedule(Task task) override {
+        size_t self = currentShard();
+        return scheduleOn(self != kNoShard ? self : _nextShard.fetch_add(1, std::memory_order_relaxed), std::move(task));
+    }
+
+    Admission scheduleOn(size_t shard, Func task, Priority priority = Priority::Normal) {
+        return scheduleOn(shard, Task(std::move(task), priority));
+    }
+
+    //Same key, same shard: a key's tasks run in order on one core
+    template<typename Key, typename Hash = std::hash<Key>>
+    Admission scheduleByKey(const Key& key, Func task, Priority priority = Priority::Normal) {
+        return scheduleOn(Hash{}(key) % _shards.size(), std::move(task), priority);
+    }
+
+    //Timer on the calling shard's own wheel, off the pool it falls back to scheduleAfter()
+    template<typename Rep, typename Period>
+    void scheduleLocalAfter(std::chrono::duration<Rep, Period> delay, Func task, Priority priority = Priority::Normal) {
+        size_t self = currentShard();
+        if (self == kNoShard) {
+            scheduleAfter(delay, std::move(task), priority);
+            return;
+        }
+
+        Task timed(std::move(task), priority);
+        forceAdmit(priority);
+        auto when = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+        if (_shards[self]->timers.insert(when, timed) == kInvalidTimer) {
+            _shards[self]->queued.fetch_add(1, std::memory_order_relaxed);
+            _shards[self]->local.push_back(std::move(timed));
+        }
+    }
+
+    size_t shardCount() const { return _shards.size(); }
+
+    //Executor-wide work plus every shard's queued tasks, wherever they sit
+    size_t pendingTasks() const override {
+        size_t pending = Executor::pendingTasks();
+        for (auto& shard : _shards) pending += shard->queued.load(std::memory_order_relaxed);
+        return pending;
+    }
+
+    //Shard of the calling thread, kNoShard outside the pool
+    size_t currentShard() const {
+        return current() == this ? currentWorkerSlot() : kNoShard;
+    }
+
+    struct ShardStats {
+        size_t tasksRun{0};
+        size_t ringSends{0};     //tasks sent to other shards over SPSC rings
+        size_t ringOverflows{0}; //sends that found the ring full and used the inbox
+    };
+
+    std::vector<ShardStats> shardStats() const {
+        std::vector<ShardStats> stats;
+        for (auto& shard : _shards) {
+            stats.push_back({shard->tasksRun.load(std::memory_order_relaxed),
+                             shard->ringSends.load(std::memory_order_relaxed),
+                             shard->ringOverflows.load(std::memory_order_relaxed)});
+        }
+        return stats;
+    }
+
+    //Same order as run(): inbound, deadline, resumptions, LIFO slot and local, then executor-wide work
+    bool runPendingTask() override {
+        size_t self = currentShard();
+        if (self == kNoShard) return false;
+        Shard& shard = *_shards[self];
+        NestedRun outer;
+        Task task([] {});
+
+        pullInbound(shard);
+        if (!popDeadlineTask(task) && !popResumeTask(task)) {
+            if (popLifoTask(task, true) || popLocal(shard, task) || popLifoTask(task, false)) {
+                shardTaskTaken(shard, task);
+            } else if (!popGlobalTask(task)) {
+                return false;
+            }
+        }
+        runTask(shard, task);
+        return true;
+    }
+
+protected:
+    Admission scheduleOn(size_t shard, Task task) {
+        if (isStopped()) return Admission::Rejected;
+        if (_bounded) {
+            auto admission = admit(task);
+            if (admission != Admission::Queued) return admission;
+        }
+
+        sampleEnqueue(task);
+        shard %= _shards.size();
+        //Count first so the shard never sees more tasks than queued
+        _shards[shard]->queued.fetch_add(1, std::memory_order_relaxed);
+        if (shard != currentShard()) {
+            routeTo(shard, std::move(task));
+            return Admission::Queued;
+        }
+        //Our own shard: the LIFO slot, what it displaces goes to the back of the queue.
+        //No wake-up, only this shard runs either and it is the caller.
+        if (_config.lifoSlotBudget == 0 || swapLifo(task)) _shards[shard]->local.push_back(std::move(task));
+        return Admission::Queued;
+    }
+
+    void run() override {
+        size_t self = currentWorkerSlot();
+        Shard& shard = *_shards[self];
+        std::vector<Task> expired;
+        Task task([] {});
+
+        while (!isStopped()) {
+            pullInbound(shard);
+            if (!shard.timers.empty()) {
+                shard.timers.advance(std::chrono::steady_clock::now(), expired);
+                shard.queued.fetch_add(expired.size(), std::memory_order_relaxed);
+                for (auto& timed : expired) {
+                    sampleEnqueue(timed);
+                    shard.local.push_back(std::move(timed));
+                }
+                expired.clear();
+            }
+
+            size_t ran = 0;
+            //Coroutine resumptions are shared by all shards, one per round like global work
+            if (popResumeTask(task)) {
+                runTask(shard, task);
+                ++ran;
+            }
+            for (size_t i = 0; i < kShardBatch; ++i, ++ran) {
+                //Deadline tasks go first, a local backlog mustn't make them late
+                if (popDeadlineTask(task)) {
+                    runTask(shard, task);
+                    continue;
+                }
+                if (!popLifoTask(task, true) && !popLocal(shard, task) && !popLifoTask(task, false)) break;
+                shardTaskTaken(shard, task);
+                runTask(shard, task);
+            }
+            //Executor-wide work, one per round so local work isn't starved
+            if (popGlobalTask(task)) {
+                runTask(shard, task);
+                ++ran;
+            }
+
+            if (ran == 0) idle(shard);
+        }
+    }
+
+    //Executor-wide submissions: nudge shards round robin, stop wakes them all
+    void wakeWorkers(size_t count) override {
+        if (count >= _shards.size()) {
+            for (auto& shard : _shards) shard->wake.notifyAll();
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            _shards[_nextShard.fetch_add(1, std::memory_order_relaxed) % _shards.size()]->wake.notifyOne();
+        }
+    }
+
+private:
+    //Tasks run from the local queue before looking at inbound and global work again
+    static constexpr size_t kShardBatch = 64;
+    static constexpr size_t kRingCapacity = 256;
+
+    struct Shard {
+        Shard(size_t id, size_t shardCount, std::chrono::steady_clock::duration tick) : local(&pool), timers(tick) {
+            inbound.resize(shardCount);
+            for (size_t sender = 0; sender < shardCount; ++sender) {
+                if (sender != id) inbound[sender] = std::make_unique<SpscRing<Task>>(kRingCapacity);
+            }
+        }
+
+        //Owner only. The pool hands out its first block on the owner's first push.
+        std::pmr::unsynchronized_pool_resource pool;
+        std::pmr::deque<Task> local;
+        TimerWheel<Task> timers;
+
+        //inbound[s] is written by shard s only, the inbox by everyone else
+        std::vector<std::unique_ptr<SpscRing<Task>>> inbound;
+        MPMCQueue<Task> inbox;
+        EventCount wake;
+
+        //Tasks headed for this shard and not yet taken: rings, inbox, local queue
+        //and LIFO slot. Senders add, the owner subtracts.
+        std::atomic<size_t> queued{0};
+
+        std::atomic<size_t> tasksRun{0};
+        std::atomic<size_t> ringSends{0};
+        std::atomic<size_t> ringOverflows{0};
+    };
+
+    static Config shardConfig(Config config) {
+        //Fixed pool, one worker per shard, no stealing
+        config.threadCount = std::max<size_t>(config.threadCount, 1);
+        config.minThreads = config.threadCount;
+        config.enableWorkStealing = false;
+        if (config.placement == Placement::Unpinned) config.placement = Placement::Compact;
+        return config;
+    }
+
+    //A full ring spills to the inbox, per-pair FIFO only holds while the ring keeps up
+    void routeTo(size_t target, Task&& task) {
+        Shard& dest = *_shards[target];
+        size_t self = currentShard();
+        if (self != kNoShard) {
+            Shard& sender = *_shards[self];
+            if (dest.inbound[self]->try_push(std::move(task))) {
+                addCounter(sender.ringSends);
+                dest.wake.notifyOne();
+                return;
+            }
+            addCounter(sender.ringOverflows);
+        }
+        dest.inbox.push(std::move(task));
+        dest.wake.notifyOne();
+    }
+
+    void pullInbound(Shard& shard) {
+        Task task([] {});
+        for (auto& ring : shard.inbound) {
+            if (!ring) continue;
+            while (ring->try_pop(task)) shard.local.push_back(std::move(task));
+        }
+        while (shard.inbox.try_pop(task)) shard.local.push_back(std::move(task));
+    }
+
+    bool popLocal(Shard& shard, Task& task) {
+        if (shard.local.empty()) return false;
+        task = std::move(shard.local.front());
+        shard.local.pop_front();
+        return true;
+    }
+
+    //A task taken from the shard's local queue or LIFO slot
+    void shardTaskTaken(Shard& shard, const Task& task) {
+        shard.queued.fetch_sub(1, std::memory_order_relaxed);
+        releaseSlot(task.priority);
+    }
+
+    //_pendingTasks is the Executor-wide work every shard polls, our own is checked directly
+    bool hasWork(Shard& shard) const {
+        if (!shard.local.empty() || !shard.inbox.empty()) return true;
+        if (_pendingTasks.load(std::memory_order_relaxed) > 0) return true;
+        for (auto& ring : shard.inbound) {
+            if (ring && !ring->empty()) return true;
+        }
+        return false;
+    }
+
+    void idle(Shard& shard) {
+        for (size_t i = 0; i < _config.idleSpinIterations; ++i) {
+            cpuRelax();
+            if (hasWork(shard) || isStopped()) return;
+        }
+
+        //Announce we are parking, then re-check so a racing sender isn't missed
+        auto key = shard.wake.prepareWait();
+        if (hasWork(shard) || isStopped()) {
+            shard.wake.cancelWait();
+            return;
+        }
+        auto deadline = std::chrono::steady_clock::now() + _config.keepAliveTime;
+        if (auto next = shard.timers.nextExpiry()) deadline = std::min(deadline, *next);
+        shard.wake.waitUntil(key, deadline);
+    }
+
+    void runTask(Shard& shard, Task& task) {
+        recordQueueWait(task);
+        executeTask(task);
+        addCounter(shard.tasksRun);
+    }
+
+    //Single writer counters
+    static void addCounter(std::atomic<size_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::atomic<size_t> _nextShard{0};
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+//Bounded single producer / single consumer ring (Lamport with cached indices).
+//Each side owns one index and keeps a stale copy of the other, so the shared
+//cache lines are only touched when the cached view says full / empty.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity = 1024)
+      : _capacity(std::bit_ceil(std::max(capacity, size_t{2}))),
+        _mask(_capacity - 1),
+        _slots(new Slot[_capacity]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    ~SpscRing() {
+        for (size_t i = _head.load(); i != _tail.load(); ++i) {
+            std::launder(reinterpret_cast<T*>(_slots[i & _mask].storage))->~T();
+        }
+    }
+
+    //Producer only, false when full
+    bool try_push(T&& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _headCache == _capacity) {
+            _headCache = _head.load(std::memory_order_acquire);
+            if (tail - _headCache == _capacity) return false;
+        }
+        ::new (static_cast<void*>(_slots[tail & _mask].storage)) T(std::move(value));
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer only
+    bool try_pop(T& value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tailCache) {
+            _tailCache = _tail.load(std::memory_order_acquire);
+            if (head == _tailCache) return false;
+        }
+        T* slot = std::launder(reinterpret_cast<T*>(_slots[head & _mask].storage));
+        value = std::move(*slot);
+        slot->~T();
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Approximate from any thread other than the consumer
+    bool empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return _capacity; }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+
+    alignas(64) std::atomic<size_t> _head{0}; //consumer
+    size_t _tailCache{0};
+    alignas(64) std::atomic<size_t> _tail{0}; //producer
+    size_t _headCache{0};
+};
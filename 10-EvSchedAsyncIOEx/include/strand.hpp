@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "executor.hpp"
+
+//Serial executor on top of Executor: tasks posted to one strand run one at a time,
+//in post order, on whichever worker picks the strand up. Different strands run in
+//parallel. Posting is lock free, an intrusive MPSC queue (Vyukov) plus a pending
+//count whose 0 -> 1 transition schedules a drain task on the executor.
+//A strand is a few pointers, it must outlive the tasks posted to it.
+class Strand {
+public:
+    using Func = Executor::Func;
+
+    explicit Strand(Executor& executor, Executor::Priority priority = Executor::Priority::Normal)
+      : _executor(executor), _priority(priority), _head(&_stub), _tail(&_stub) {}
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    ~Strand() {
+        //Tasks that never got to run are dropped
+        while (Node* node = tryPop()) delete node;
+    }
+
+    //False when the executor is stopped, the task is dropped
+    bool post(Func task) {
+        if (_executor.isStopped()) return false;
+        push(new Node(std::move(task)));
+
+        //First pending task owns the drain, later ones ride along
+        if (_pending.fetch_add(1, std::memory_order_acq_rel) == 0) scheduleDrain();
+        return true;
+    }
+
+    //True inside a task this strand is running
+    bool runningInThisThread() const { return currentStrand == this; }
+
+    size_t pending() const { return _pending.load(std::memory_order_relaxed); }
+
+private:
+    //Tasks run per drain before the strand requeues itself, so a busy strand
+    //doesn't hold a worker forever
+    static constexpr size_t kDrainBudget = 64;
+
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        Func func;
+
+        Node() = default;
+        explicit Node(Func f) : func(std::move(f)) {}
+    };
+
+    //The pending count stays owned until a drain runs, so a refused drain task
+    //(stopped, Reject/ShedLow policy) runs here instead of stranding the strand
+    void scheduleDrain() {
+        auto admission = _executor.schedule([this] () { drain(); }, _priority);
+        if (admission == Executor::Admission::Rejected || admission == Executor::Admission::Shed) drain();
+    }
+
+    void drain() {
+        const Strand* outer = currentStrand;
+        currentStrand = this;
+
+        while (true) {
+            for (size_t ran = 0; ran < kDrainBudget; ++ran) {
+                Node* node = popPending();
+                try {
+                    node->func();
+                } catch (const std::exception& e) {
+                    std::cerr << "Strand task exception: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Unknown strand task exception occurred" << std::endl;
+                }
+                delete node;
+
+                if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    currentStrand = outer;
+                    return; //drained, the next post schedules a new drain
+                }
+            }
+
+            //Still owned, go to the back of the line, past the LIFO slot and the
+            //local deque that would hand it straight back. Refused: keep going here.
+            if (_executor.yieldTask([this] () { drain(); }, _priority)) break;
+        }
+
+        currentStrand = outer;
+    }
+
+    //Any thread
+    void push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    //Drain only. _pending says a node is there, a producer may still be
+    //between its exchange and the link store, wait it out.
+    Node* popPending() {
+        while (true) {
+            if (Node* node = tryPop()) return node;
+            cpuRelax();
+        }
+    }
+
+    Node* tryPop() {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (!next) return nullptr;
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        if (tail != _head.load(std::memory_order_acquire)) return nullptr; //push in flight
+
+        //tail is the last node, put the stub behind it so tail can be handed out
+        push(&_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    Executor& _executor;
+    Executor::Priority _priority;
+    Node _stub;
+    std::atomic<Node*> _head; //producers
+    Node* _tail;              //drain only
+    std::atomic<size_t> _pending{0};
+
+    thread_local static inline const Strand* currentStrand = nullptr;
+};
+
+//Per-key ordering without a strand per key: keys hash onto a fixed set of strands,
+//so one key's tasks are serial and in order while other keys run in parallel.
+//Unrelated keys sharing a strand are serialised with each other, size it well
+//above the worker count.
+template <typename Key, typename Hash = std::hash<Key>>
+class KeyedStrands {
+public:
+    explicit KeyedStrands(Executor& executor, size_t strandCount = 256,
+                          Executor::Priority priority = Executor::Priority::Normal) {
+        _strands.reserve(std::max<size_t>(strandCount, 1));
+        for (size_t i = 0; i < std::max<size_t>(strandCount, 1); ++i) {
+            _strands.emplace_back(std::make_unique<Strand>(executor, priority));
+        }
+    }
+
+    bool post(const Key& key, Strand::Func task) {
+        return strandFor(key).post(std::move(task));
+    }
+
+    Strand& strandFor(const Key& key) {
+        return *_strands[_hash(key) % _strands.size()];
+    }
+
+    size_t size() const { return _strands.size(); }
+
+private:
+    std::vector<std::unique_ptr<Strand>> _strands;
+    Hash _hash;
+};
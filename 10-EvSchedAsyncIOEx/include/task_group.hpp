@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include "executor.hpp"
+#include "resume_queue.hpp"
+
+//Join counter for a set of tasks on one Executor. spawn() counts a task in and
+//its completion out, add() / arrive() count work the group can't see (I/O
+//callbacks, other pools). The count reaching zero is signalled exactly once:
+//blocked wait() callers are woken and co_await-ing coroutines resumed on the
+//executor. Nothing polls.
+//
+//wait() blocks the calling thread, from inside the pool co_await the group
+//instead where possible. The group waits for its tasks when destroyed, so they can't outlive it.
+class TaskGroup {
+public:
+    explicit TaskGroup(Executor& executor) : _executor(executor) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        wait();
+        //The last arrival may still be inside complete(), let it leave first
+        while (_arriving.load(std::memory_order_acquire) != 0) cpuRelax();
+    }
+
+    //Tasks the overflow policy rejects or sheds count as done
+    template<typename F>
+    Executor::Admission spawn(F&& task, Executor::Priority priority = Executor::Priority::Normal) {
+        add(1);
+        auto admission = _executor.schedule([this, task = std::forward<F>(task)] () mutable {
+            Arrival arrival{*this}; //arrives even if the task throws
+            task();
+        }, priority);
+        if (admission == Executor::Admission::Rejected || admission == Executor::Admission::Shed) arrive();
+        return admission;
+    }
+
+    void add(size_t count) {
+        _pending.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void arrive() {
+        _arriving.fetch_add(1, std::memory_order_relaxed);
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+        _arriving.fetch_sub(1, std::memory_order_release);
+    }
+
+    size_t pending() const { return _pending.load(std::memory_order_acquire); }
+
+    //On one of the executor's own workers this runs queued tasks until the group is
+    //done: parking for good there could leave our own tasks with nobody to run them.
+    //With nothing to run it parks on _done too, waking every kHelpRecheck to look
+    //for work that turned up meanwhile.
+    void wait() {
+        bool onWorker = Executor::current() == &_executor;
+        while (pending() != 0) {
+            if (onWorker && _executor.runPendingTask()) continue;
+
+            auto key = _done.prepareWait();
+            if (pending() == 0) {
+                _done.cancelWait();
+                return;
+            }
+            _done.waitUntil(key, onWorker ? std::chrono::steady_clock::now() + kHelpRecheck
+                                          : std::chrono::steady_clock::time_point::max());
+        }
+    }
+
+    struct Awaiter {
+        TaskGroup& group;
+        ResumeNode node{};
+
+        bool await_ready() const noexcept { return group.pending() == 0; }
+
+        //false resumes right away, the group finished while we were getting here
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(group._waitersMutex);
+            if (group.pending() == 0) return false;
+            node.handle = handle;
+            node.next = group._waiters;
+            group._waiters = &node;
+            ++group._waiterCount;
+            return true;
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    Awaiter operator co_await() noexcept { return Awaiter{*this, {}}; }
+
+private:
+    static constexpr std::chrono::microseconds kHelpRecheck{500};
+
+    struct Arrival {
+        TaskGroup& group;
+        ~Arrival() { group.arrive(); }
+    };
+
+    //Only the arrival that takes the count to zero gets here
+    void complete() {
+        ResumeNode* waiters;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(_waitersMutex);
+            waiters = std::exchange(_waiters, nullptr);
+            count = std::exchange(_waiterCount, 0);
+        }
+        _done.notifyAll();
+
+        //The awaiters' own nodes are the chain, resuming them allocates nothing
+        if (count == 0 || _executor.scheduleResume(*waiters, count)) return;
+        //A stopped executor must not lose the coroutines
+        while (waiters) {
+            ResumeNode* next = waiters->next;
+            waiters->handle.resume();
+            waiters = next;
+        }
+    }
+
+    Executor& _executor;
+    std::atomic<size_t> _pending{0};
+    std::atomic<size_t> _arriving{0};
+    EventCount _done;
+    std::mutex _waitersMutex;
+    ResumeNode* _waiters{nullptr}; //linked through the suspended awaiters
+    size_t _waiterCount{0};
+};
@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+//Hierarchical timing wheel: 6 levels of 64 slots, level n slots are 64^n ticks wide,
+//which covers 2^36 ticks (~2 years at 1 ms). Insert and cancel are O(1): an entry is
+//linked into the slot its expiry falls in and cascades to lower levels as time
+//approaches it. advance() hands back everything due in one pass, a tick's worth of
+//timers at a time. Not thread safe, the owner serialises access.
+template <typename T>
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t; //generation << 32 | node index, stale ids never match
+
+    static constexpr TimerId kInvalidTimer = std::numeric_limits<TimerId>::max();
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now())
+      : _tick(tick), _start(start) {}
+
+    //Due now or in the past: returns kInvalidTimer and leaves value untouched,
+    //the caller should run it straight away
+    TimerId insert(Clock::time_point when, T& value) {
+        uint64_t tick = toTick(when);
+        if (tick <= _elapsed) return kInvalidTimer;
+
+        uint32_t index = allocateNode();
+        Node& node = _nodes[index];
+        node.when = std::min(tick, _elapsed + kMaxTicks);
+        node.value.emplace(std::move(value));
+        link(index);
+        ++_size;
+        return (static_cast<TimerId>(node.generation) << 32) | index;
+    }
+
+    bool cancel(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        if (id == kInvalidTimer || index >= _nodes.size()) return false;
+
+        Node& node = _nodes[index];
+        if (!node.armed || node.generation != static_cast<uint32_t>(id >> 32)) return false;
+
+        unlink(index);
+        releaseNode(index);
+        --_size;
+        return true;
+    }
+
+    //Move every timer due at `now` into expired (appended), returns how many
+    size_t advance(Clock::time_point now, std::vector<T>& expired) {
+        //Only whole ticks have passed
+        uint64_t nowTick = now <= _start ? 0 : static_cast<uint64_t>((now - _start) / _tick);
+        size_t fired = 0;
+
+        while (auto next = nextExpiration()) {
+            if (next->deadline > nowTick) break;
+            _elapsed = next->deadline;
+
+            //Take the whole slot, anything not due yet cascades to a lower level
+            uint32_t index = _slots[next->level][next->slot];
+            _slots[next->level][next->slot] = kNil;
+            _occupied[next->level] &= ~(uint64_t{1} << next->slot);
+
+            while (index != kNil) {
+                uint32_t following = _nodes[index].next;
+                Node& node = _nodes[index];
+                node.armed = false;
+                if (node.when <= _elapsed) {
+                    expired.emplace_back(std::move(*node.value));
+                    releaseNode(index);
+                    --_size;
+                    ++fired;
+                } else {
+                    link(index);
+                }
+                index = following;
+            }
+        }
+
+        if (nowTick > _elapsed) _elapsed = nowTick;
+        return fired;
+    }
+
+    //Start of the earliest occupied slot, a lower bound for the next expiry
+    std::optional<Clock::time_point> nextExpiry() const {
+        auto next = nextExpiration();
+        if (!next) return std::nullopt;
+        return _start + static_cast<int64_t>(next->deadline) * _tick;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = size_t{1} << kSlotBits;
+    static constexpr size_t kLevels = 6;
+    static constexpr uint64_t kMaxTicks = (uint64_t{1} << (kSlotBits * kLevels)) - 1;
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        uint64_t when{0};
+        uint32_t prev{kNil};
+        uint32_t next{kNil};
+        uint32_t generation{0};
+        uint8_t level{0};
+        uint8_t slot{0};
+        bool armed{false};
+        std::optional<T> value;
+    };
+
+    struct Expiration {
+        size_t level;
+        size_t slot;
+        uint64_t deadline;
+    };
+
+    uint64_t toTick(Clock::time_point when) const {
+        if (when <= _start) return 0;
+        //Round up so timers never fire early
+        auto ticks = (when - _start + _tick - Clock::duration(1)) / _tick;
+        return static_cast<uint64_t>(ticks);
+    }
+
+    //Highest 6-bit group where `when` and `_elapsed` differ
+    size_t levelFor(uint64_t when) const {
+        uint64_t masked = (_elapsed ^ when) | (kSlots - 1);
+        size_t significant = 63 - std::countl_zero(masked);
+        return std::min(significant / kSlotBits, kLevels - 1);
+    }
+
+    void link(uint32_t index) {
+        Node& node = _nodes[index];
+        size_t level = levelFor(node.when);
+        size_t slot = (node.when >> (level * kSlotBits)) & (kSlots - 1);
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>(slot);
+        node.prev = kNil;
+        node.next = _slots[level][slot];
+        if (node.next != kNil) _nodes[node.next].prev = index;
+        _slots[level][slot] = index;
+        _occupied[level] |= uint64_t{1} << slot;
+        node.armed = true;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = _nodes[index];
+        if (node.prev != kNil) _nodes[node.prev].next = node.next;
+        else _slots[node.level][node.slot] = node.next;
+        if (node.next != kNil) _nodes[node.next].prev = node.prev;
+        if (_slots[node.level][node.slot] == kNil) _occupied[node.level] &= ~(uint64_t{1} << node.slot);
+        node.armed = false;
+    }
+
+    std::optional<Expiration> nextExpiration() const {
+        for (size_t level = 0; level < kLevels; ++level) {
+            if (_occupied[level] == 0) continue;
+
+            uint64_t slotRange = uint64_t{1} << (level * kSlotBits);
+            uint64_t levelRange = slotRange << kSlotBits;
+            size_t nowSlot = (_elapsed / slotRange) & (kSlots - 1);
+            size_t slot = (std::countr_zero(std::rotr(_occupied[level], static_cast<int>(nowSlot))) + nowSlot) & (kSlots - 1);
+
+            uint64_t levelStart = _elapsed & ~(levelRange - 1);
+            uint64_t deadline = levelStart + slot * slotRange;
+            //Only possible for timers clamped to the top level, they wrap a whole rotation
+            if (deadline <= _elapsed) deadline += levelRange;
+            return Expiration{level, slot, deadline};
+        }
+        return std::nullopt;
+    }
+
+    uint32_t allocateNode() {
+        if (_freeHead != kNil) {
+            uint32_t index = _freeHead;
+            _freeHead = _nodes[index].next;
+            return index;
+        }
+        _nodes.emplace_back();
+        return static_cast<uint32_t>(_nodes.size() - 1);
+    }
+
+    void releaseNode(uint32_t index) {
+        Node& node = _nodes[index];
+        node.value.reset();
+        node.armed = false;
+        ++node.generation;
+        node.next = _freeHead;
+        _freeHead = index;
+    }
+
+    Clock::duration _tick;
+    Clock::time_point _start;
+    uint64_t _elapsed{0};
+    size_t _size{0};
+
+    std::vector<Node> _nodes;
+    uint32_t _freeHead{kNil};
+    std::array<std::array<uint32_t, kSlots>, kLevels> _slots = makeEmptySlots();
+    std::array<uint64_t, kLevels> _occupied{};
+
+    static std::array<std::array<uint32_t, kSlots>, kLevels> makeEmptySlots() {
+        std::array<std::array<uint32_t, kSlots>, kLevels> slots;
+        for (auto& level : slots) level.fill(kNil);
+        return slots;
+    }
+};
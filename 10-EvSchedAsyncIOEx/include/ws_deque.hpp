@@ -0,0 +1,256 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "event_count.hpp"
+
+//Chase-Lev work stealing deque (Le et al., "Correct and Efficient Work-Stealing
+//for Weak Memory Models"). The owning worker pushes and pops at the bottom (LIFO)
+//with plain loads/stores, it only CASes when racing a thief for the last element.
+//Thieves steal FIFO from the top with a single CAS.
+//
+//stealBatch() claims up to half the deque with one CAS on top as well. A claim of
+//several could reach the slots the owner pops without a CAS, so a batch thief
+//raises _batchStealing from before reading bottom until its CAS, and an owner pop
+//that sees it waits for the claim before reading top. Seq_cst fences on both
+//sides: either the thief sees the owner's lowered bottom or the owner sees the
+//flag. One batch thief at a time, the others fall back to steal().
+//
+//Elements live in cells owned by the deque. Cells freed by thieves are handed back
+//through a lock-free stack, so a warmed up deque allocates nothing per push.
+template <typename T>
+class WorkStealingDeque {
+public:
+    static constexpr size_t kMaxBatch = 128; //tasks one stealBatch() takes at most
+
+private:
+    struct Cell {
+        std::optional<T> data;
+        Cell* next{nullptr}; //free list link
+    };
+
+    struct Ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<Cell*>[]> slots;
+
+        explicit Ring(int64_t cap) : capacity(cap), slots(new std::atomic<Cell*>[cap]) {}
+
+        Cell* get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, Cell* cell) { slots[i & (capacity - 1)].store(cell, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> _top{0};
+    std::atomic<bool> _batchStealing{false}; //on top's line, pop reads them together
+    alignas(64) std::atomic<int64_t> _bottom{0};
+    alignas(64) std::atomic<Ring*> _ring{nullptr};
+    alignas(64) std::atomic<Cell*> _remoteFreeCells{nullptr};
+
+    //Owner only. Old rings stay alive because a thief may still be reading them.
+    Cell* _freeCells{nullptr};
+    bool _homed{false};
+    size_t _cellChunkSize;
+    std::vector<std::unique_ptr<Cell[]>> _cellChunks;
+    std::vector<std::unique_ptr<Ring>> _rings;
+
+    Ring* grow(Ring* ring, int64_t bottom, int64_t top, int64_t capacity) {
+        auto bigger = std::make_unique<Ring>(capacity);
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, ring->get(i));
+        }
+        ring = bigger.get();
+        _rings.emplace_back(std::move(bigger));
+        _ring.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    Cell* acquireCell() {
+        if (!_freeCells) {
+            _freeCells = _remoteFreeCells.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (!_freeCells) {
+            auto chunk = std::make_unique<Cell[]>(_cellChunkSize);
+            for (size_t i = 0; i < _cellChunkSize; ++i) {
+                chunk[i].next = _freeCells;
+                _freeCells = &chunk[i];
+            }
+            _cellChunks.emplace_back(std::move(chunk));
+            _cellChunkSize <<= 1;
+        }
+        auto cell = _freeCells;
+        _freeCells = cell->next;
+        return cell;
+    }
+
+    void releaseCell(Cell* cell) {
+        cell->next = _freeCells;
+        _freeCells = cell;
+    }
+
+    //Called by thieves, only ever pushes so there is no ABA on the stack
+    void releaseCellRemote(Cell* cell) {
+        auto head = _remoteFreeCells.load(std::memory_order_relaxed);
+        do {
+            cell->next = head;
+        } while (!_remoteFreeCells.compare_exchange_weak(head, cell,
+                    std::memory_order_release, std::memory_order_relaxed));
+    }
+
+public:
+    explicit WorkStealingDeque(size_t initCapacity = 256)
+      : _cellChunkSize(std::bit_ceil(std::max(initCapacity, size_t{2}))) {
+        auto ring = std::make_unique<Ring>(static_cast<int64_t>(_cellChunkSize));
+        _ring.store(ring.get(), std::memory_order_relaxed);
+        _rings.emplace_back(std::move(ring));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    //Owner only, once: re-allocate the ring and a first cell chunk from the owning
+    //thread so first-touch places them on its NUMA node (call after pinning)
+    void rehome() {
+        if (_homed) return;
+        _homed = true;
+
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+        grow(ring, b, t, ring->capacity);
+        if (!_freeCells) releaseCell(acquireCell());
+    }
+
+    //Owner only
+    void push(T value) {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+        if (b - t > ring->capacity - 1) ring = grow(ring, b, t, ring->capacity << 1);
+
+        Cell* cell = acquireCell();
+        cell->data.emplace(std::move(value));
+        ring->put(b, cell);
+        _bottom.store(b + 1, std::memory_order_release);
+    }
+
+    //Owner only, publishes the whole range with one store to bottom
+    template <typename It>
+    void pushBulk(It first, It last) {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_acquire);
+        int64_t count = static_cast<int64_t>(std::distance(first, last));
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+
+        int64_t capacity = ring->capacity;
+        while (b - t + count > capacity) capacity <<= 1;
+        if (capacity != ring->capacity) ring = grow(ring, b, t, capacity);
+
+        for (int64_t i = b; first != last; ++first, ++i) {
+            Cell* cell = acquireCell();
+            cell->data.emplace(std::move(*first));
+            ring->put(i, cell);
+        }
+        _bottom.store(b + count, std::memory_order_release);
+    }
+
+    //Owner only, LIFO
+    bool pop(T& value) {
+        int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        //A batch thief may have read bottom before we lowered it, let its claim land
+        while (_batchStealing.load(std::memory_order_acquire)) cpuRelax();
+        int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b) { //empty
+            _bottom.store(b + 1, std::memory_order_release);
+            return false;
+        }
+
+        Cell* cell = ring->get(b);
+        if (t == b) { //last element, race the thieves for it
+            bool won = _top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_release);
+            if (!won) return false;
+        }
+
+        value = std::move(*cell->data);
+        cell->data.reset();
+        releaseCell(cell);
+        return true;
+    }
+
+    //Any thread, FIFO
+    bool steal(T& value) {
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+
+        Cell* cell = _ring.load(std::memory_order_acquire)->get(t);
+        if (!_top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false; //lost the race to the owner or another thief
+        }
+
+        value = std::move(*cell->data);
+        cell->data.reset();
+        releaseCellRemote(cell);
+        return true;
+    }
+
+    //Any thread: up to half the deque, at most maxCount, claimed with one CAS on
+    //top. The oldest goes to first, the rest are pushed onto into, which the
+    //caller must own. Returns how many were taken, 0 when empty or contended.
+    size_t stealBatch(T& first, WorkStealingDeque& into, size_t maxCount) {
+        if (_batchStealing.exchange(true, std::memory_order_seq_cst)) {
+            return steal(first) ? 1 : 0; //another batch thief is at it
+        }
+
+        int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            _batchStealing.store(false, std::memory_order_release);
+            return 0;
+        }
+
+        //Round up so a single task can be stolen, still never more than half of
+        //a longer deque, the owner keeps the newest
+        auto count = std::min<int64_t>((b - t + 1) / 2, static_cast<int64_t>(std::min<size_t>(maxCount, kMaxBatch)));
+        //Cell pointers before the CAS, afterwards the owner may reuse ring slots
+        Ring* ring = _ring.load(std::memory_order_acquire);
+        Cell* cells[kMaxBatch];
+        for (int64_t i = 0; i < count; ++i) cells[i] = ring->get(t + i);
+
+        bool won = _top.compare_exchange_strong(t, t + count,
+            std::memory_order_seq_cst, std::memory_order_relaxed);
+        _batchStealing.store(false, std::memory_order_release);
+        if (!won) return 0; //a single thief or the owner got there first
+
+        first = std::move(*cells[0]->data);
+        cells[0]->data.reset();
+        releaseCellRemote(cells[0]);
+        for (int64_t i = 1; i < count; ++i) {
+            into.push(std::move(*cells[i]->data));
+            cells[i]->data.reset();
+            releaseCellRemote(cells[i]);
+        }
+        return static_cast<size_t>(count);
+    }
+
+    //Approximate when called concurrently
+    size_t size() const {
+        int64_t b = _bottom.load(std::memory_order_relaxed);
+        int64_t t = _top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+};
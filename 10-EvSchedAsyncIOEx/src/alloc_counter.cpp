@@ -0,0 +1,21 @@
+#include <cstdlib>
+#include <new>
+
+// Global operator new / delete counting heap allocations per thread. Only linked
+// into task_alloc_benchmark, so the other benchmarks keep the stock allocator.
+// Kept out of the benchmark's translation unit so the compiler can't pair an
+// inlined free() with operator new and flag it as a mismatch.
+namespace {
+    thread_local size_t threadAllocations = 0;
+}
+
+size_t allocationsOnThisThread() { return threadAllocations; }
+
+void* operator new(std::size_t size) {
+    ++threadAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
@@ -24,14 +24,15 @@ void demoAsyncFS() {
 
     //Ex 3: Process dir async
     std::atomic<size_t> fileCount = 0;
+    TaskGroup dirGroup(asyncFSExecutor);
     asyncFSExecutor.processDirAsync("./data", [&fileCount] (const auto& entry) {
         fileCount++;
         //Process file content
         std::cout << "Processing: " << entry.path() <<std::endl;
-    });
+    }, &dirGroup);
     
     //Wait for completion
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    dirGroup.wait();
     std::cout << "Processed: " << fileCount << " files\n";
 
     asyncFSExecutor.stop();
@@ -71,7 +72,6 @@ void runFSExecutorBenchmark() {
 
     // Setup async executor
     Executor::Config config;
-    config.threadCount = std::thread::hardware_concurrency();
     AsyncFSExecutor executor(config);
     executor.start();
     
@@ -3,9 +3,79 @@
 #include "event_benchmarker.hpp"
 #include "batch_executor.hpp"
 #include "async_fs_executor.hpp"
+#include "task_group.hpp"
+#include "parallel_algorithms.hpp"
 
 void runFSExecutorBenchmark();
 
+void printStealStats(const Executor& executor) {
+    auto stats = executor.stealStats();
+    std::cout << "Steals: " << stats.successes << " successful out of " << stats.attempts
+              << " attempts, " << stats.tasksStolen << " tasks moved" << std::endl;
+}
+
+void printIdleStats(const Executor& executor) {
+    Executor::IdleStats total;
+    for (auto& worker : executor.idleStats()) {
+        total.spinning += worker.spinning;
+        total.yielding += worker.yielding;
+        total.parked += worker.parked;
+        total.parks += worker.parks;
+        total.taskYields += worker.taskYields;
+    }
+    auto ms = [](std::chrono::nanoseconds d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+    std::cout << "Idle (all workers): spinning " << ms(total.spinning) << "ms, yielding "
+              << ms(total.yielding) << "ms, parked " << ms(total.parked) << "ms in "
+              << total.parks << " parks, " << total.taskYields << " task yields" << std::endl;
+}
+
+void printDeadlineStats(const Executor& executor) {
+    auto stats = executor.deadlineStats();
+    std::cout << "Deadlines: " << stats.met << " met, " << stats.missed << " missed";
+    for (size_t b = 0; b < stats.missLateness.size(); ++b) {
+        if (stats.missLateness[b]) std::cout << " [" << stats.bucketLabels[b] << " late: " << stats.missLateness[b] << "]";
+    }
+    std::cout << std::endl;
+}
+
+void printScalingStats(Executor& executor) {
+    auto stats = executor.scalingStats();
+    std::cout << "Scaling: " << stats.scaleUps << " up, " << stats.scaleDowns << " down, "
+              << stats.idleRetirements << " idle retirements, " << executor.activeThreads()
+              << " threads now, " << stats.standbyActivations << " standby activations, "
+              << stats.threadsCreated << " threads created, " << stats.standby << " on standby" << std::endl;
+}
+
+// Only populated when built with EXECUTOR_LATENCY_HISTOGRAMS
+void printLatencyStats(const Executor& executor) {
+    if (!Executor::kLatencyHistograms) return;
+    constexpr std::array<const char*, 3> levelNames{"High", "Normal", "Low"};
+    auto stats = executor.latencyStats();
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    for (size_t p = 0; p < levelNames.size(); ++p) {
+        auto& wait = stats.wait[p];
+        auto& run = stats.run[p];
+        if (run.count == 0) continue;
+        std::cout << "Latency " << levelNames[p] << " (" << run.count << " tasks): wait p50 " << us(wait.percentile(0.5))
+                  << "us p99 " << us(wait.percentile(0.99)) << "us max " << us(wait.max) << "us, run p50 "
+                  << us(run.percentile(0.5)) << "us p99 " << us(run.percentile(0.99)) << "us max " << us(run.max)
+                  << "us" << std::endl;
+    }
+}
+
+// What the default Executor::Config is sized from
+void printCpuLimits() {
+    auto& limits = CpuTopology::limits();
+    std::cout << "CPUs: " << limits.hardwareThreads << " hardware threads, " << limits.affinityCpus
+              << " in the affinity mask, ";
+    if (limits.quotaCpus > 0) std::cout << "cgroup quota " << limits.quotaCpus << " (" << limits.quotaSource << ")";
+    else std::cout << "no cgroup quota";
+    std::cout << ", " << limits.usableCpus << " usable -> " << Executor::Config{}.threadCount
+              << " worker threads by default" << std::endl;
+}
+
 void runExecutorBenchmark(Executor& executor, const std::string& name) {
     std::cout << "\nTesting " << name << "..." << std::endl;
     
@@ -13,9 +83,15 @@ void runExecutorBenchmark(Executor& executor, const std::string& name) {
     constexpr int NUM_TASKS = 1000000;
     std::atomic<int> completed{0};
     auto start = std::chrono::high_resolution_clock::now();
+
+    // Deadline probes riding along the CPU load to measure SLO compliance
+    constexpr int PROBE_EVERY = 1000;
+    constexpr auto PROBE_BUDGET = std::chrono::milliseconds(5);
+    std::atomic<int> probesDone{0};
+    TaskGroup group(executor);
     
     for (int i = 0; i < NUM_TASKS; ++i) {
-        executor.schedule([&completed] () {
+        group.spawn([&completed] () {
             // CPU-bound work
             volatile double result = 0l;
             for(int j = 0; j < 1000; ++j) {
@@ -23,30 +99,687 @@ void runExecutorBenchmark(Executor& executor, const std::string& name) {
             }
             ++completed;
         });
+
+        if (i % PROBE_EVERY == 0) {
+            group.add(1);
+            executor.scheduleWithDeadline([&probesDone, &group] () { ++probesDone; group.arrive(); }, PROBE_BUDGET);
+        }
     }
     
-    while (completed < NUM_TASKS) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10)); 
-    }
+    group.wait();
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     
     std::cout << name << " completed " << completed << " out of " << NUM_TASKS
      << " tasks in " << duration.count() << "ms" << std::endl;
+    printStealStats(executor);
+    printIdleStats(executor);
+    printDeadlineStats(executor);
+    printScalingStats(executor);
+    printLatencyStats(executor);
     
     executor.stop();
 }
 
+// Same CPU load submitted one schedule() at a time and in scheduleBatch() chunks
+void runBatchScheduleBenchmark(size_t batchSize) {
+    Executor::Config config;
+    Executor executor(config);
+    std::string name = batchSize == 1 ? "schedule()" : "scheduleBatch(" + std::to_string(batchSize) + ")";
+    std::cout << "\nTesting Submission via " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_TASKS = 1000000;
+    std::atomic<int> completed{0};
+    TaskGroup group(executor);
+    group.add(NUM_TASKS);
+    auto makeTask = [&completed, &group] {
+        return Executor::Task([&completed, &group] () {
+            volatile double result = 0l;
+            for(int j = 0; j < 1000; ++j) {
+                result = result + j * j * 3.14;
+            }
+            ++completed;
+            group.arrive();
+        });
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Executor::Task> batch;
+    batch.reserve(batchSize);
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        if (batchSize == 1) {
+            executor.schedule(makeTask());
+            continue;
+        }
+        batch.emplace_back(makeTask());
+        if (batch.size() == batchSize || i == NUM_TASKS - 1) {
+            executor.scheduleBatch(std::span<Executor::Task>(batch));
+            batch.clear();
+        }
+    }
+    auto submitted = std::chrono::high_resolution_clock::now();
+
+    group.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    executor.stop();
+
+    std::cout << name << " submitted " << NUM_TASKS << " tasks in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(submitted - start).count()
+              << "ms, completed in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+              << "ms" << std::endl;
+}
+
+// One task per element against parallel_for / parallel_reduce chunks on the same kernel
+void runParallelForBenchmark(int kernelIterations) {
+    Executor::Config config;
+    Executor executor(config);
+    std::cout << "\nTesting parallel_for with a " << kernelIterations << " iteration kernel..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_ELEMENTS = 1000000;
+    auto kernel = [kernelIterations] (int i) {
+        volatile double result = 0l;
+        for(int j = 0; j < kernelIterations; ++j) {
+            result = result + j * j * 3.14;
+        }
+        return result + i;
+    };
+    auto report = [] (const std::string& name, auto start) {
+        auto elapsed = std::chrono::high_resolution_clock::now() - start;
+        std::cout << name << " processed " << NUM_ELEMENTS << " elements in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << "ms" << std::endl;
+    };
+
+    std::vector<double> out(NUM_ELEMENTS);
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        TaskGroup group(executor);
+        for (int i = 0; i < NUM_ELEMENTS; ++i) {
+            group.spawn([&out, &kernel, i] () { out[i] = kernel(i); });
+        }
+        group.wait();
+    }
+    report("  one task per element", start);
+
+    start = std::chrono::high_resolution_clock::now();
+    parallel_for(executor, 0, NUM_ELEMENTS, [&out, &kernel] (int i) { out[i] = kernel(i); });
+    report("  parallel_for (auto grain)", start);
+
+    start = std::chrono::high_resolution_clock::now();
+    double sum = parallel_reduce(executor, 0, NUM_ELEMENTS, 0.0, kernel, std::plus<double>());
+    report("  parallel_reduce (auto grain)", start);
+    std::cout << "  checksum " << sum << std::endl;
+
+    executor.stop();
+}
+
+// Message passing: each hop schedules the next one from inside a task, along with
+// a piece of background work. Without the LIFO slot a hop queues behind that work.
+void runPingPongBenchmark(bool sharded, size_t lifoSlotBudget) {
+    Executor::Config config;
+    config.lifoSlotBudget = lifoSlotBudget;
+    std::unique_ptr<Executor> executor;
+    if (sharded) executor = std::make_unique<ShardedExecutor>(config);
+    else executor = std::make_unique<Executor>(config);
+    std::string name = std::string(sharded ? "Sharded" : "Work stealing") + " ping-pong, LIFO slot "
+                     + (lifoSlotBudget ? "budget " + std::to_string(lifoSlotBudget) : "off");
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor->start();
+    constexpr int NUM_HOPS = 100000;
+    std::vector<long long> hopLatencies(NUM_HOPS);
+    TaskGroup chain(*executor);
+    TaskGroup background(*executor);
+    chain.add(1);
+
+    std::function<void(int, std::chrono::steady_clock::time_point)> hop =
+        [&] (int i, std::chrono::steady_clock::time_point queuedAt) {
+        auto now = std::chrono::steady_clock::now();
+        hopLatencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - queuedAt).count();
+        background.spawn([] () {
+            volatile double result = 0l;
+            for(int j = 0; j < 100; ++j) {
+                result = result + j * j * 3.14;
+            }
+        });
+        if (i + 1 == NUM_HOPS) {
+            chain.arrive();
+            return;
+        }
+        executor->schedule([&hop, i, now = std::chrono::steady_clock::now()] () { hop(i + 1, now); });
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    executor->schedule([&hop] () { hop(0, std::chrono::steady_clock::now()); });
+    chain.wait();
+    auto chainDone = std::chrono::high_resolution_clock::now();
+    background.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    executor->stop();
+
+    std::sort(hopLatencies.begin(), hopLatencies.end());
+    std::cout << name << ": hop wait median " << hopLatencies[NUM_HOPS / 2] << " ns, p99 "
+              << hopLatencies[NUM_HOPS * 99 / 100] << " ns, " << NUM_HOPS << " hops in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(chainDone - start).count()
+              << "ms, background done in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+              << "ms" << std::endl;
+}
+
+// Per-key ordered updates: one lock around all session state vs a strand per key
+void runStrandBenchmark(bool useStrands) {
+    Executor::Config config;
+    Executor executor(config);
+    std::string name = useStrands ? "Keyed strands" : "Global mutex";
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_TASKS = 1000000;
+    constexpr int NUM_KEYS = 1024;
+    std::atomic<int> completed{0};
+    std::vector<long long> sessionState(NUM_KEYS, 0);
+    std::mutex stateMutex;
+    KeyedStrands<int> strands(executor, NUM_KEYS);
+    TaskGroup group(executor);
+    group.add(NUM_TASKS);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        int key = i % NUM_KEYS;
+        auto update = [&sessionState, &completed, &group, key] () {
+            volatile double result = 0l;
+            for(int j = 0; j < 100; ++j) {
+                result = result + j * j * 3.14;
+            }
+            ++sessionState[key];
+            ++completed;
+            group.arrive();
+        };
+        if (useStrands) {
+            strands.post(key, update);
+        } else {
+            executor.schedule([&stateMutex, update] () mutable {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                update();
+            });
+        }
+    }
+
+    group.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    executor.stop();
+
+    std::cout << name << " completed " << completed << " ordered updates over " << NUM_KEYS << " keys in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+}
+
+// Message chains hopping between keyed stages: the stealing pool runs a hop on any
+// worker, the sharded pool keeps each key on its own core and hands off over SPSC rings
+void runShardHopBenchmark(bool sharded) {
+    Executor::Config config;
+    ShardedExecutor* shardedExecutor = nullptr;
+    std::unique_ptr<Executor> executor;
+    if (sharded) {
+        auto owned = std::make_unique<ShardedExecutor>(config);
+        shardedExecutor = owned.get();
+        executor = std::move(owned);
+    } else {
+        executor = std::make_unique<Executor>(config);
+    }
+    std::string name = sharded ? "Sharded hops (scheduleByKey)" : "Work stealing hops (schedule)";
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor->start();
+    constexpr int NUM_CHAINS = 10000;
+    constexpr int NUM_HOPS = 100;
+    constexpr int NUM_KEYS = 1024;
+    TaskGroup chains(*executor);
+    chains.add(NUM_CHAINS);
+
+    std::function<void(int, int)> hop = [&](int key, int remaining) {
+        volatile double result = 0l;
+        for(int j = 0; j < 100; ++j) {
+            result = result + j * j * 3.14;
+        }
+        if (remaining == 0) {
+            chains.arrive();
+            return;
+        }
+        int next = (key * 31 + 7) % NUM_KEYS;
+        auto step = [&hop, next, remaining] () { hop(next, remaining - 1); };
+        if (shardedExecutor) shardedExecutor->scheduleByKey(next, step);
+        else executor->schedule(step);
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_CHAINS; ++i) {
+        int key = i % NUM_KEYS;
+        auto step = [&hop, key] () { hop(key, NUM_HOPS); };
+        if (shardedExecutor) shardedExecutor->scheduleByKey(key, step);
+        else executor->schedule(step);
+    }
+
+    chains.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    executor->stop();
+
+    std::cout << name << " completed " << NUM_CHAINS * NUM_HOPS << " hops in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    if (shardedExecutor) {
+        ShardedExecutor::ShardStats total;
+        for (auto& shard : shardedExecutor->shardStats()) {
+            total.ringSends += shard.ringSends;
+            total.ringOverflows += shard.ringOverflows;
+        }
+        std::cout << "Cross-shard: " << total.ringSends << " ring sends, "
+                  << total.ringOverflows << " ring overflows" << std::endl;
+    }
+}
+
+// Long Low priority coroutines with yield points, plus a trickle of High tasks:
+// without a time slice a High task waits for a whole Low task to finish
+EventScheduler::Task longLowTask(TaskGroup& group) {
+    for (int chunk = 0; chunk < 2000; ++chunk) {
+        volatile double result = 0l;
+        for(int j = 0; j < 1000; ++j) {
+            result = result + j * j * 3.14;
+        }
+        co_await maybeYield();
+    }
+    group.arrive();
+}
+
+void runYieldBenchmark(std::chrono::microseconds timeSlice) {
+    Executor::Config config;
+    config.timeSlice = timeSlice;
+    Executor executor(config);
+    std::string name = timeSlice.count() ? "Time slice " + std::to_string(timeSlice.count()) + "us" : "No time slice";
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_LOW = 200;
+    constexpr int NUM_HIGH = 200;
+    TaskGroup group(executor);
+    group.add(NUM_LOW); //each coroutine arrives when it finishes
+    std::vector<std::optional<EventScheduler::Task>> lowTasks(NUM_LOW);
+    std::vector<long long> highLatencies(NUM_HIGH);
+
+    for (int i = 0; i < NUM_LOW; ++i) {
+        executor.schedule([&lowTasks, &group, i] () { lowTasks[i].emplace(longLowTask(group)); },
+                          Executor::Priority::Low);
+    }
+    for (int i = 0; i < NUM_HIGH; ++i) {
+        auto queuedAt = std::chrono::steady_clock::now();
+        group.spawn([&highLatencies, queuedAt, i] () {
+            auto waited = std::chrono::steady_clock::now() - queuedAt;
+            highLatencies[i] = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+        }, Executor::Priority::High);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    group.wait();
+    printIdleStats(executor);
+    executor.stop();
+
+    std::sort(begin(highLatencies), end(highLatencies));
+    std::cout << name << " High task wait: median " << highLatencies[NUM_HIGH / 2] << " us, p99 "
+              << highLatencies[NUM_HIGH * 99 / 100] << " us, max " << highLatencies.back() << " us" << std::endl;
+}
+
+// A request that waits on I/O, then does CPU work on the result
+EventScheduler::Task blockingRequest(Executor& executor, TaskGroup& group) {
+    co_await offloadBlocking(executor);
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    co_await resumeOnCpu(executor);
+    volatile double result = 0l;
+    for(int j = 0; j < 1000; ++j) {
+        result = result + j * j * 3.14;
+    }
+    group.arrive();
+}
+
+// 08's sleeping tasks mixed with compute: on the CPU workers vs offloaded to the blocking pool
+void runBlockingOffloadBenchmark(bool offload) {
+    Executor::Config config;
+    Executor executor(config);
+    std::string name = offload ? "Blocking pool offload" : "Blocking on CPU workers";
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_REQUESTS = 2000;
+    constexpr int NUM_CPU_TASKS = 100000;
+    std::vector<std::optional<EventScheduler::Task>> requests(NUM_REQUESTS);
+    TaskGroup requestGroup(executor);
+    TaskGroup cpuGroup(executor);
+    requestGroup.add(NUM_REQUESTS);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_REQUESTS; ++i) {
+        if (offload) {
+            executor.schedule([&executor, &requests, &requestGroup, i] () {
+                requests[i].emplace(blockingRequest(executor, requestGroup));
+            });
+        } else {
+            executor.schedule([&requestGroup] () {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                volatile double result = 0l;
+                for(int j = 0; j < 1000; ++j) {
+                    result = result + j * j * 3.14;
+                }
+                requestGroup.arrive();
+            });
+        }
+        for (int k = 0; k < NUM_CPU_TASKS / NUM_REQUESTS; ++k) {
+            cpuGroup.spawn([] () {
+                volatile double result = 0l;
+                for(int j = 0; j < 1000; ++j) {
+                    result = result + j * j * 3.14;
+                }
+            });
+        }
+    }
+
+    cpuGroup.wait();
+    auto cpuDone = std::chrono::high_resolution_clock::now();
+    requestGroup.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto blocking = executor.blockingStats();
+    executor.stop();
+
+    std::cout << name << ": " << NUM_CPU_TASKS << " CPU tasks in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(cpuDone - start).count() << "ms, "
+              << NUM_REQUESTS << " blocking requests in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms, "
+              << "blocking threads peak " << blocking.peakThreads << std::endl;
+}
+
+// Skewed producer: one worker spawns every task into its own local queue,
+// the rest of the pool only gets work by stealing it
+void runStealingBenchmark(bool stealHalf) {
+    Executor::Config config;
+    config.minThreads = config.threadCount;
+    config.enableStealHalf = stealHalf;
+
+    Executor executor(config);
+    std::string name = stealHalf ? "Steal half" : "Steal one";
+    std::cout << "\nTesting " << name << " (skewed producer)..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_TASKS = 200000;
+    std::atomic<int> completed{0};
+    auto start = std::chrono::high_resolution_clock::now();
+
+    TaskGroup group(executor);
+    group.spawn([&group, &completed] () {
+        for (int i = 0; i < NUM_TASKS; ++i) {
+            group.spawn([&completed] () {
+                volatile double result = 0l;
+                for(int j = 0; j < 1000; ++j) {
+                    result = result + j * j * 3.14;
+                }
+                ++completed;
+            });
+        }
+    });
+
+    group.wait();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    std::cout << name << " completed " << completed << " out of " << NUM_TASKS
+     << " tasks in " << duration.count() << "ms" << std::endl;
+    printStealStats(executor);
+
+    executor.stop();
+}
+
+// Runaway producer against bounded queues: the queues hold at most 4096 tasks per
+// level whatever the producer does, the overflow policy decides who pays for it
+void runAdmissionBenchmark(Executor::OverflowPolicy policy, const std::string& name) {
+    Executor::Config config;
+    config.queueCapacity = {4096, 4096, 4096};
+    config.overflowPolicy = policy;
+    Executor executor(config);
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_TASKS = 1000000;
+    std::atomic<int> completed{0};
+    int dropped = 0;
+    TaskGroup group(executor);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        // Every fourth task High, every fourth Low, the rest Normal
+        auto priority = i % 4 == 0 ? Executor::Priority::High
+                      : i % 4 == 3 ? Executor::Priority::Low : Executor::Priority::Normal;
+        auto admission = group.spawn([&completed] () {
+            volatile double result = 0l;
+            for(int j = 0; j < 1000; ++j) {
+                result = result + j * j * 3.14;
+            }
+            ++completed;
+        }, priority);
+        if (admission == Executor::Admission::Rejected || admission == Executor::Admission::Shed) ++dropped;
+    }
+
+    group.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    executor.stop();
+
+    std::cout << name << " completed " << completed << " and dropped " << dropped << " out of " << NUM_TASKS
+              << " tasks in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    constexpr std::array<const char*, 3> levelNames{"High", "Normal", "Low"};
+    auto stats = executor.admissionStats();
+    for (size_t p = 0; p < stats.size(); ++p) {
+        std::cout << "  " << levelNames[p] << ": " << stats[p].queued << " queued, " << stats[p].blocked << " blocked, "
+                  << stats[p].rejected << " rejected, " << stats[p].ranInline << " ran inline, "
+                  << stats[p].shed << " shed" << std::endl;
+    }
+}
+
+// A steady High stream with a trickle of Low tasks: report how long the Low
+// tasks wait. With strict priorities they only run once the flood is drained.
+// fromWorker submits from inside a task, onto the worker's own deques.
+void runPriorityBenchmark(const std::array<size_t, 3>& weights, const std::string& name, bool fromWorker = false) {
+    Executor::Config config;
+    config.priorityWeights = weights;
+    Executor executor(config);
+    std::cout << "\nTesting " << name << "..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_HIGH = 200000;
+    constexpr int LOW_EVERY = 2000;
+    std::atomic<int> completed{0};
+    std::vector<long long> lowLatencies(NUM_HIGH / LOW_EVERY);
+    TaskGroup group(executor);
+
+    auto submit = [&] () {
+        for (int i = 0; i < NUM_HIGH; ++i) {
+            group.spawn([&completed] () {
+                volatile double result = 0l;
+                for(int j = 0; j < 1000; ++j) {
+                    result = result + j * j * 3.14;
+                }
+                ++completed;
+            }, Executor::Priority::High);
+
+            if (i % LOW_EVERY == 0) {
+                auto queuedAt = std::chrono::high_resolution_clock::now();
+                group.spawn([&completed, &lowLatencies, queuedAt, slot = i / LOW_EVERY] () {
+                    auto waited = std::chrono::high_resolution_clock::now() - queuedAt;
+                    lowLatencies[slot] = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+                    ++completed;
+                }, Executor::Priority::Low);
+            }
+        }
+    };
+    if (fromWorker) group.spawn(submit);
+    else submit();
+
+    group.wait();
+    executor.stop();
+
+    std::sort(begin(lowLatencies), end(lowLatencies));
+    std::cout << name << " Low task wait: median " << lowLatencies[lowLatencies.size() / 2]
+              << " us, max " << lowLatencies.back() << " us" << std::endl;
+    printLatencyStats(executor);
+}
+
+// Bursts of work separated by quiet gaps, starting from a single thread:
+// the pool should grow into each burst and shrink after, without flapping
+void runScalingBenchmark() {
+    Executor::Config config;
+    config.threadCount = std::max<size_t>(4, config.threadCount);
+    config.minThreads = 1;
+    Executor executor(config);
+    std::cout << "\nTesting Adaptive scaling..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_BURSTS = 5;
+    constexpr int TASKS_PER_BURST = 100000;
+    std::atomic<int> completed{0};
+
+    for (int burst = 0; burst < NUM_BURSTS; ++burst) {
+        TaskGroup burstGroup(executor);
+        for (int i = 0; i < TASKS_PER_BURST; ++i) {
+            burstGroup.spawn([&completed] () {
+                volatile double result = 0l;
+                for(int j = 0; j < 1000; ++j) {
+                    result = result + j * j * 3.14;
+                }
+                ++completed;
+            });
+        }
+        burstGroup.wait();
+        // Trickle keeps workers dequeuing through the gap so the controller sees it quiet
+        for (int i = 0; i < 100; ++i) {
+            executor.schedule([] () {});
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    auto stats = executor.scalingStats();
+    auto start = stats.recent.empty() ? std::chrono::steady_clock::now() : stats.recent.front().at;
+    for (auto& decision : stats.recent) {
+        auto at = std::chrono::duration_cast<std::chrono::milliseconds>(decision.at - start).count();
+        std::cout << "  +" << at << "ms "
+                  << (decision.action == Executor::ScalingDecision::Action::ScaleUp ? "up  " : "down")
+                  << " from " << decision.threadsBefore << " threads, wait " << decision.queueWait.count()
+                  << "us, utilization " << static_cast<int>(decision.utilization * 100) << "%, pending "
+                  << decision.pendingTasks << std::endl;
+    }
+    printScalingStats(executor);
+    executor.stop();
+}
+
+// First task into an empty pool: what schedule() costs the caller and how long
+// until the task runs, with a parked standby worker and with none
+void runColdStartBenchmark(size_t standbyThreads) {
+    std::cout << "\nTesting Cold start, " << standbyThreads << " standby threads..." << std::endl;
+    constexpr int NUM_STARTS = 20;
+    std::vector<long long> scheduleNs, dispatchNs;
+
+    for (int i = 0; i < NUM_STARTS; ++i) {
+        Executor::Config config;
+        config.minThreads = 0;
+        config.standbyThreads = standbyThreads;
+        Executor executor(config);
+        executor.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5)); //standby threads park
+
+        TaskGroup group(executor);
+        group.add(1);
+        std::chrono::steady_clock::time_point ranAt;
+        auto start = std::chrono::steady_clock::now();
+        executor.schedule([&] () {
+            ranAt = std::chrono::steady_clock::now();
+            group.arrive();
+        });
+        auto scheduled = std::chrono::steady_clock::now();
+        group.wait();
+        executor.stop();
+
+        scheduleNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(scheduled - start).count());
+        dispatchNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(ranAt - start).count());
+    }
+
+    std::sort(scheduleNs.begin(), scheduleNs.end());
+    std::sort(dispatchNs.begin(), dispatchNs.end());
+    std::cout << "Cold start, " << standbyThreads << " standby: schedule() median " << scheduleNs[NUM_STARTS / 2] / 1000.0
+              << " us, first task running after median " << dispatchNs[NUM_STARTS / 2] / 1000.0
+              << " us, max " << dispatchNs.back() / 1000.0 << " us" << std::endl;
+}
+
+// A million pending timers: cost of insert / cancel with the wheel full,
+// then how late the surviving half fires
+void runTimerBenchmark() {
+    Executor::Config config;
+    Executor executor(config);
+    std::cout << "\nTesting Timer wheel..." << std::endl;
+
+    executor.start();
+    constexpr int NUM_TIMERS = 1000000;
+    constexpr long long MAX_DELAY_MS = 1000;
+    std::atomic<int> fired{0};
+    std::vector<long long> lateness(NUM_TIMERS / 2);
+    std::vector<Executor::TimerId> ids(NUM_TIMERS);
+    TaskGroup group(executor);
+    group.add(NUM_TIMERS); //a timer arrives when it fires or is cancelled
+
+    // Far enough out that nothing fires before the cancel pass is over
+    auto base = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_TIMERS; ++i) {
+        auto due = base + std::chrono::milliseconds((i * 7919LL) % MAX_DELAY_MS);
+        ids[i] = executor.scheduleAt(due, [&fired, &lateness, &group, due, slot = i / 2] () {
+            auto late = std::chrono::steady_clock::now() - due;
+            lateness[slot] = std::chrono::duration_cast<std::chrono::microseconds>(late).count();
+            ++fired;
+            group.arrive();
+        });
+    }
+    auto inserted = std::chrono::high_resolution_clock::now();
+
+    // Cancel every odd timer
+    for (int i = 1; i < NUM_TIMERS; i += 2) {
+        if (executor.cancelTimer(ids[i])) group.arrive();
+    }
+    auto cancelled = std::chrono::high_resolution_clock::now();
+
+    group.wait();
+    executor.stop();
+
+    auto nsPer = [](auto d) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / (NUM_TIMERS / 2);
+    };
+    std::sort(begin(lateness), end(lateness));
+    std::cout << "Timer wheel: insert " << nsPer(inserted - start) / 2 << " ns, cancel "
+              << nsPer(cancelled - inserted) << " ns, " << fired << " fired, lateness median "
+              << lateness[lateness.size() / 2] << " us, max " << lateness.back() << " us" << std::endl;
+}
+
 void runExecutorBenchmarks() {
     std::cout << "\n=== CPU-Bound Task Benchmarks ===" << std::endl;
+    printCpuLimits();
 
     // Test regular executor
     Executor::Config config;
-    config.threadCount = std::thread::hardware_concurrency();
     
     Executor regularExecutor(config);
     runExecutorBenchmark(regularExecutor, "Regular Executor");
+
+    // Same pool pinned to cores, spread across NUMA nodes
+    Executor::Config pinnedConfig = config;
+    pinnedConfig.placement = Executor::Placement::Spread;
+    Executor pinnedExecutor(pinnedConfig);
+    runExecutorBenchmark(pinnedExecutor, "Regular Executor (pinned, spread)");
+
+    // Thread-per-core, one shard per worker and no stealing
+    ShardedExecutor shardedExecutor(config);
+    runExecutorBenchmark(shardedExecutor, "Sharded Executor");
     
     // Batch Executor benchmarks with different batch sizes
     std::vector<size_t> batchSizes = {8, 16, 32, 64, 128, 256};
@@ -57,9 +790,65 @@ void runExecutorBenchmarks() {
         runExecutorBenchmark(batchExecutor, "Batch Executor (batch size: " + std::to_string(batchSize) + ")");
     }
 
+    // Per-task vs bulk submission
+    runBatchScheduleBenchmark(1);
+    runBatchScheduleBenchmark(1024);
+
+    // Per-element tasks against chunked fork-join, coarse and fine kernels
+    runParallelForBenchmark(1000);
+    runParallelForBenchmark(100);
+
+    // High priority tail latency behind long Low tasks
+    runYieldBenchmark(std::chrono::microseconds(0));
+    runYieldBenchmark(std::chrono::microseconds(200));
+
+    // Per-key serialisation
+    runStrandBenchmark(false);
+    runStrandBenchmark(true);
+
+    // Keyed hand-offs between stages
+    runShardHopBenchmark(false);
+    runShardHopBenchmark(true);
+
+    // Follow-up latency with and without the LIFO slot
+    runPingPongBenchmark(false, 0);
+    runPingPongBenchmark(false, Executor::Config{}.lifoSlotBudget);
+    runPingPongBenchmark(true, 0);
+    runPingPongBenchmark(true, Executor::Config{}.lifoSlotBudget);
+
+    // Low priority latency under a High flood
+    runPriorityBenchmark({1, 0, 0}, "Strict priorities");
+    runPriorityBenchmark(Executor::Config{}.priorityWeights, "Weighted priorities");
+    runPriorityBenchmark({1, 0, 0}, "Strict priorities, submitted from a worker", true);
+    runPriorityBenchmark(Executor::Config{}.priorityWeights, "Weighted priorities, submitted from a worker", true);
+
+    // Overload against bounded queues
+    runAdmissionBenchmark(Executor::OverflowPolicy::Block, "Bounded queues, block");
+    runAdmissionBenchmark(Executor::OverflowPolicy::Reject, "Bounded queues, reject");
+    runAdmissionBenchmark(Executor::OverflowPolicy::RunInline, "Bounded queues, run inline");
+    runAdmissionBenchmark(Executor::OverflowPolicy::ShedLow, "Bounded queues, shed Low");
+
+    // Pool size following a bursty load
+    runScalingBenchmark();
+
+    // Growing an empty pool: standby worker vs a thread from the controller
+    runColdStartBenchmark(Executor::Config{}.standbyThreads);
+    runColdStartBenchmark(0);
+
+    // Timer insert / cancel cost and firing accuracy
+    runTimerBenchmark();
+
+    // Work stealing victim selection
+    runStealingBenchmark(false);
+    runStealingBenchmark(true);
+
     // Add FS benchmark
     std::cout << "\n=== I/O-Bound Task Benchmarks ===" << std::endl;
     runFSExecutorBenchmark();
+
+    // Sleeping requests next to compute, with and without the blocking pool
+    runBlockingOffloadBenchmark(false);
+    runBlockingOffloadBenchmark(true);
 }
 
 void runEventSystemBenchmark() {
@@ -0,0 +1,105 @@
+#include "executor.hpp"
+#include "task_group.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Heap allocations made by the calling thread so far, see alloc_counter.cpp
+size_t allocationsOnThisThread();
+
+namespace {
+
+// makeStdFunc and makeTask build the same work, the former in the copyable
+// shape std::function needs. Every call arrives on done once.
+template<typename MakeStdFunc, typename MakeTask>
+void measureCapture(Executor& executor, TaskGroup& done, const std::string& name,
+                    MakeStdFunc makeStdFunc, MakeTask makeTask) {
+    constexpr int NUM_TASKS = 100000;
+    done.add(2 * NUM_TASKS);
+
+    // What the old std::function based Task paid just to wrap the callable
+    size_t before = allocationsOnThisThread();
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        std::function<void()> func(makeStdFunc());
+        func();
+    }
+    double stdFunctionAllocs = static_cast<double>(allocationsOnThisThread() - before) / NUM_TASKS;
+
+    // Full schedule() path with Executor::Task, including queue node growth
+    before = allocationsOnThisThread();
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        executor.schedule(makeTask());
+    }
+    double scheduleAllocs = static_cast<double>(allocationsOnThisThread() - before) / NUM_TASKS;
+
+    std::cout << name << ": std::function " << stdFunctionAllocs
+              << " allocs/task, Executor::schedule " << scheduleAllocs << " allocs/task" << std::endl;
+}
+
+}
+
+int main() {
+    std::cout << "Testing Executor::Task allocations (inline capacity: "
+              << Executor::Func::kCapacity << " bytes, sizeof(Task): "
+              << sizeof(Executor::Task) << " bytes)..." << std::endl;
+
+    Executor::Config config;
+    Executor executor(config);
+    executor.start();
+
+    // Tasks arrive through a reference, the same capture the counter they
+    // replace took, so the group adds nothing to what is measured
+    TaskGroup done(executor);
+
+    // Typical benchmark task, one reference
+    auto small = [&done] {
+        return [&done] { done.arrive(); };
+    };
+    measureCapture(executor, done, "8 byte capture", small, small);
+
+    // Three pointers + a shared_ptr, over the std::function SBO
+    auto shared = std::make_shared<int>(42);
+    auto medium = [&done, &shared] {
+        return [&done, a = &done, b = &done, shared] { done.arrive(); (void)a; (void)b; };
+    };
+    measureCapture(executor, done, "40 byte capture", medium, medium);
+
+    // Move-only state, std::function needs it wrapped in a shared_ptr
+    measureCapture(executor, done, "move-only capture",
+        [&done] {
+            return [&done, value = std::make_shared<std::unique_ptr<int>>(std::make_unique<int>(1))] { done.arrive(); };
+        },
+        [&done] {
+            return [&done, value = std::make_unique<int>(1)] { done.arrive(); };
+        });
+
+    // Coroutine resumption, as a lambda through schedule() and as the awaiter's
+    // own ResumeNode through scheduleResume()
+    constexpr int NUM_RESUMES = 100000;
+    std::coroutine_handle<> noop = std::noop_coroutine();
+    std::vector<ResumeNode> nodes(NUM_RESUMES);
+
+    done.add(NUM_RESUMES);
+    size_t before = allocationsOnThisThread();
+    for (int i = 0; i < NUM_RESUMES; ++i) {
+        executor.schedule([noop, &done] { noop.resume(); done.arrive(); });
+    }
+    double scheduleAllocs = static_cast<double>(allocationsOnThisThread() - before) / NUM_RESUMES;
+
+    before = allocationsOnThisThread();
+    for (auto& node : nodes) {
+        node.handle = noop;
+        executor.scheduleResume(node);
+    }
+    double resumeAllocs = static_cast<double>(allocationsOnThisThread() - before) / NUM_RESUMES;
+
+    std::cout << "coroutine resume: Executor::schedule " << scheduleAllocs
+              << " allocs/resume, Executor::scheduleResume " << resumeAllocs << " allocs/resume" << std::endl;
+
+    // The noop resumptions can't arrive anywhere. stop() joins the workers before
+    // nodes goes out of scope, so any still queued are never read.
+    done.wait();
+    executor.stop();
+    return 0;
+}